@@ -12,6 +12,7 @@
 #include <QGridLayout>
 #include <QMenuBar>
 #include <QDialogButtonBox>
+#include <QStandardPaths>
 
 // CustomerDialog Implementation
 CustomerDialog::CustomerDialog(QWidget *parent, bool editMode)
@@ -106,6 +107,7 @@ CRM_Dashboard::CRM_Dashboard(QWidget *parent, const QString &email, const QStrin
     try {
         // Initialize OrderManager FIRST
         m_orderManager = std::make_shared<OrderManager>(this);
+        m_orderManager->openJournal(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
 
         // Set window properties
         setWindowTitle("CRM Dashboard");
@@ -519,7 +521,7 @@ void CRM_Dashboard::buildSideDock()
     // FIX: Add null check before connecting signals
     if (m_orderManager) {
         // Update order statistics
-        connect(m_orderManager.get(), &OrderManager::orderAdded, this, [this]() {
+        connect(m_orderManager.get(), &OrderManager::dataChanged, this, [this]() {
             if (m_totalOrdersLabel && m_totalRevenueLabel && m_orderManager) {
                 m_totalOrdersLabel->setText(QString::number(m_orderManager->getTotalOrderCount()));
                 m_totalRevenueLabel->setText(QString("$%1").arg(m_orderManager->getTotalRevenue(), 0, 'f', 2));
@@ -0,0 +1,383 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include "ordercolumnstore.h"
+#include "ordermanager.h"
+#include "parallelscan.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+
+// Counts heap allocations: malloc, calloc and realloc, which operator new
+// and Qt's container and string buffers all go through. Only glibc lets the
+// benchmark wrap them; elsewhere the counts are reported as unavailable.
+static std::atomic<qint64> allocations{0};
+
+#ifdef __GLIBC__
+static constexpr bool countsAllocations = true;
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+
+void* malloc(size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+}
+#else
+static constexpr bool countsAllocations = false;
+#endif
+
+namespace {
+
+QTextStream& out() {
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+// Keeps results alive so the compiler cannot drop the timed work
+volatile double sink = 0;
+
+template <typename Fn>
+double msecsOf(Fn fn) {
+    QElapsedTimer timer;
+    timer.start();
+    fn();
+    return timer.nsecsElapsed() / 1e6;
+}
+
+// Best of several runs, which filters out page faults and other noise
+template <typename Fn>
+double bestMsecsOf(Fn fn, int runs = 10) {
+    double best = msecsOf(fn);
+    for (int i = 1; i < runs; ++i) {
+        best = qMin(best, msecsOf(fn));
+    }
+    return best;
+}
+
+QString perOp(double msecs, int ops) {
+    return QStringLiteral("%1 us/op").arg(msecs * 1000 / qMax(1, ops), 0, 'f', 3);
+}
+
+// Deterministic orders spread over five years, with a customer per ten
+// orders and one to four items each
+QList<QSharedPointer<Order>> makeOrders(int count) {
+    static const QStringList products = {
+        "Laptop", "Monitor", "Keyboard", "Mouse", "Headset", "Webcam", "Dock", "Cable"
+    };
+    const QDateTime start(QDate(2020, 1, 1), QTime(0, 0));
+    const qint64 spanSecs = 5LL * 365 * 24 * 3600;
+
+    QRandomGenerator random(42);
+    QList<QSharedPointer<Order>> orders;
+    orders.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        auto order = QSharedPointer<Order>::create(Order::formatId(quint64(i + 1) << 22),
+                                                   QStringLiteral("CUST%1").arg(random.bounded(count / 10 + 1)),
+                                                   start.addSecs(random.bounded(spanSecs)));
+        order->setCustomerName(QStringLiteral("Customer %1").arg(i % 1000));
+        order->setStatus(Order::Status(random.bounded(Order::StatusCount)));
+        const int items = 1 + random.bounded(4);
+        for (int j = 0; j < items; ++j) {
+            order->addItem({products[random.bounded(products.size())], 1 + random.bounded(5),
+                            10 + random.bounded(990)});
+        }
+        orders.append(order);
+    }
+    return orders;
+}
+
+// Distinct ids spread evenly over the orders, picked up front so the timed
+// loops only do the operation
+QStringList sampleIds(const QList<QSharedPointer<Order>>& orders, int count) {
+    QStringList ids;
+    ids.reserve(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        ids.append(orders[i * orders.size() / count]->id());
+    }
+    return ids;
+}
+
+// What lookups cost before the id index: a scan over every order
+int findByScan(const QList<QSharedPointer<Order>>& orders, const QString& id) {
+    for (int i = 0; i < orders.size(); ++i) {
+        if (orders[i]->id() == id) return i;
+    }
+    return -1;
+}
+
+// Id lookup, status update and delete through OrderManager, against the
+// linear scan they used to do
+void benchmarkIdOperations(int count) {
+    constexpr int Ops = 1000;
+    constexpr int ScanOps = 100; // a scan at 1M orders takes milliseconds each
+
+    OrderManager manager;
+    const QList<QSharedPointer<Order>> orders = makeOrders(count);
+    const double addMsecs = msecsOf([&]() { manager.addOrders(orders); });
+    const QStringList ids = sampleIds(orders, qMin(Ops, count));
+    const QList<QSharedPointer<Order>> all = manager.getAllOrders();
+
+    const double scanMsecs = msecsOf([&]() {
+        for (int i = 0; i < qMin(ScanOps, int(ids.size())); ++i) {
+            sink = sink + findByScan(all, ids[i]);
+        }
+    });
+    const double lookupMsecs = msecsOf([&]() {
+        for (const QString& id : ids) {
+            sink = sink + manager.getOrder(id)->total();
+        }
+    });
+    const double updateMsecs = msecsOf([&]() {
+        for (int i = 0; i < ids.size(); ++i) {
+            manager.updateOrderStatus(ids[i], Order::Status(i % Order::StatusCount));
+        }
+    });
+    const double deleteMsecs = msecsOf([&]() {
+        for (const QString& id : ids) {
+            manager.deleteOrder(id);
+        }
+    });
+
+    out() << "  " << count << " orders: add all " << addMsecs << " ms"
+          << ", linear scan " << perOp(scanMsecs, qMin(ScanOps, int(ids.size())))
+          << ", lookup " << perOp(lookupMsecs, ids.size())
+          << ", update " << perOp(updateMsecs, ids.size())
+          << ", delete " << perOp(deleteMsecs, ids.size()) << Qt::endl;
+}
+
+// The scans the columnar store replaced: one pointer dereference per order
+double revenueByPointers(const QList<QSharedPointer<Order>>& orders, qint64 from, qint64 to) {
+    double sum = 0;
+    for (const auto& order : orders) {
+        const qint64 date = order->orderDate().toMSecsSinceEpoch();
+        if (date >= from && date <= to) sum += order->total();
+    }
+    return sum;
+}
+
+int countByPointers(const QList<QSharedPointer<Order>>& orders, Order::Status status) {
+    int count = 0;
+    for (const auto& order : orders) {
+        count += order->status() == status;
+    }
+    return count;
+}
+
+// Revenue over a date range and a status count, columnar kernels against
+// pointer-chasing loops. Both run on one thread so only the layout differs.
+void benchmarkScans(int count) {
+    const QList<QSharedPointer<Order>> orders = makeOrders(count);
+    OrderColumnStore columns;
+    columns.reserve(count);
+    for (const auto& order : orders) {
+        columns.append(*order);
+    }
+
+    const qint64 from = QDateTime(QDate(2021, 1, 1), QTime(0, 0)).toMSecsSinceEpoch();
+    const qint64 to = QDateTime(QDate(2023, 12, 31), QTime(23, 59)).toMSecsSinceEpoch();
+
+    const int threads = ParallelScan::pool()->maxThreadCount();
+    ParallelScan::pool()->setMaxThreadCount(1);
+    const double revenuePointers = bestMsecsOf([&]() { sink = sink + revenueByPointers(orders, from, to); });
+    const double revenueColumns = bestMsecsOf([&]() { sink = sink + columns.revenueInRange(from, to); });
+    const double countPointers = bestMsecsOf([&]() { sink = sink + countByPointers(orders, Order::Shipped); });
+    const double countColumns = bestMsecsOf([&]() { sink = sink + columns.countByStatus(Order::Shipped); });
+    ParallelScan::pool()->setMaxThreadCount(threads);
+
+    out() << "  " << count << " orders: revenueInRange " << revenuePointers << " -> " << revenueColumns
+          << " ms (" << revenuePointers / revenueColumns << "x)"
+          << ", countByStatus " << countPointers << " -> " << countColumns
+          << " ms (" << countPointers / countColumns << "x)" << Qt::endl;
+}
+
+// The parallel scans at 1..N scan threads. Chunking does not depend on the
+// thread count, so every run computes the same result.
+void benchmarkScaling(int count) {
+    const QList<QSharedPointer<Order>> orders = makeOrders(count);
+    OrderStore store;
+    store.reserve(count);
+    for (const auto& order : orders) {
+        store.insert(order);
+    }
+    OrderColumnStore columns;
+    columns.reserve(count);
+    for (const auto& order : orders) {
+        columns.append(*order);
+    }
+
+    const qint64 from = QDateTime(QDate(2021, 1, 1), QTime(0, 0)).toMSecsSinceEpoch();
+    const qint64 to = QDateTime(QDate(2023, 12, 31), QTime(23, 59)).toMSecsSinceEpoch();
+
+    const int threads = ParallelScan::pool()->maxThreadCount();
+    double revenueBase = 0, countBase = 0, searchBase = 0;
+    for (int n = 1; n <= QThread::idealThreadCount(); ++n) {
+        ParallelScan::pool()->setMaxThreadCount(n);
+        const double revenue = bestMsecsOf([&]() { sink = sink + columns.revenueInRange(from, to); });
+        const double statusCount = bestMsecsOf([&]() { sink = sink + columns.countByStatus(Order::Shipped); });
+        const double search = bestMsecsOf([&]() { sink = sink + store.search(QStringLiteral("keyboard")).size(); }, 3);
+        if (n == 1) {
+            revenueBase = revenue;
+            countBase = statusCount;
+            searchBase = search;
+        }
+        out() << "  " << n << (n == 1 ? " thread: " : " threads: ")
+              << "revenueInRange " << revenue << " ms (" << revenueBase / revenue << "x)"
+              << ", countByStatus " << statusCount << " ms (" << countBase / statusCount << "x)"
+              << ", search " << search << " ms (" << searchBase / search << "x)" << Qt::endl;
+    }
+    ParallelScan::pool()->setMaxThreadCount(threads);
+}
+
+// Runs fn and reports its time and heap allocations per order
+void measure(const char* label, int count, const std::function<void()>& fn) {
+    const qint64 before = allocations.load(std::memory_order_relaxed);
+    const double msecs = msecsOf(fn);
+    const qint64 made = allocations.load(std::memory_order_relaxed) - before;
+    out() << "    " << label << ": " << msecs << " ms, ";
+    if (countsAllocations) {
+        out() << made << " allocations (" << double(made) / qMax(1, count) << " per order)" << Qt::endl;
+    } else {
+        out() << "allocations not counted on this platform" << Qt::endl;
+    }
+}
+
+// The original loadFromFile: the whole file parsed into a QJsonDocument,
+// then one Order per object appended to a plain list, with no indexes
+QList<QSharedPointer<Order>> loadJsonDocument(const QString& filename) {
+    QList<QSharedPointer<Order>> orders;
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return orders;
+
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    const QJsonArray ordersArray = doc.array();
+    for (const QJsonValue& value : ordersArray) {
+        if (!value.isObject()) continue;
+
+        const QJsonObject orderObj = value.toObject();
+        auto order = QSharedPointer<Order>::create(orderObj["customerId"].toString());
+        order->setCustomerName(orderObj["customerName"].toString());
+        order->setStatus(Order::stringToStatus(orderObj["status"].toString()));
+
+        const QJsonArray itemsArray = orderObj["items"].toArray();
+        for (const QJsonValue& itemValue : itemsArray) {
+            if (!itemValue.isObject()) continue;
+
+            const QJsonObject itemObj = itemValue.toObject();
+            order->addItem(OrderItem(itemObj["productName"].toString(),
+                                     itemObj["quantity"].toInt(),
+                                     itemObj["price"].toDouble()));
+        }
+        orders.append(order);
+    }
+    return orders;
+}
+
+// Loading count orders the original way, from JSON into a plain list, against
+// today's JSON and snapshot loads, which also build every index. Then what
+// starting an async save costs on the GUI thread: deep copies of every
+// order, as it used to be, against sharing the orders and capturing their
+// statuses.
+void benchmarkPersistence(int count) {
+    QTemporaryDir dir;
+    const QString jsonPath = dir.filePath("orders.json");
+    const QString snapshotPath = dir.filePath("orders.snapshot");
+    {
+        OrderManager writer;
+        writer.addOrders(makeOrders(count));
+        writer.saveToFile(jsonPath, OrderManager::JsonFormat);
+        writer.saveToFile(snapshotPath, OrderManager::BinaryFormat);
+    }
+
+    out() << "  " << count << " orders (JSON " << QFileInfo(jsonPath).size() / 1024 << " KiB, snapshot "
+          << QFileInfo(snapshotPath).size() / 1024 << " KiB)" << Qt::endl;
+
+    measure("before: load JSON document into a list", count, [&]() {
+        sink = sink + loadJsonDocument(jsonPath).size();
+    });
+
+    OrderManager manager;
+    measure("load JSON", count, [&]() { manager.loadFromFile(jsonPath); });
+    measure("load snapshot", count, [&]() { manager.loadFromFile(snapshotPath); });
+
+    const QList<QSharedPointer<Order>> orders = manager.getAllOrders();
+    measure("save capture, deep copies", count, [&]() {
+        QList<QSharedPointer<Order>> copies;
+        copies.reserve(orders.size());
+        for (const auto& order : orders) {
+            copies.append(QSharedPointer<Order>::create(*order));
+        }
+        sink = sink + copies.size();
+    });
+    measure("save capture, shared orders", count, [&]() {
+        QList<QSharedPointer<Order>> shared = orders;
+        QList<Order::Status> statuses;
+        statuses.reserve(shared.size());
+        for (const auto& order : shared) {
+            statuses.append(order->status());
+        }
+        sink = sink + statuses.size();
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+#if !defined(NDEBUG) || !defined(QT_NO_DEBUG)
+    QTextStream(stderr) << "warning: order_benchmark was not built as Release; assertions and "
+                           "debug-only checks are included in every timing" << Qt::endl;
+#endif
+
+    QList<int> counts;
+    for (const QString& arg : app.arguments().mid(1)) {
+        const int count = arg.toInt();
+        if (count > 0) counts.append(count);
+    }
+    if (counts.isEmpty()) {
+        counts = {10000, 100000, 1000000};
+    }
+
+    out() << "Id lookup, update and delete" << Qt::endl;
+    for (int count : std::as_const(counts)) {
+        benchmarkIdOperations(count);
+    }
+
+    out() << Qt::endl << "Scans, pointers -> columns, one thread" << Qt::endl;
+    for (int count : std::as_const(counts)) {
+        benchmarkScans(count);
+    }
+
+    const int largest = *std::max_element(counts.cbegin(), counts.cend());
+    out() << Qt::endl << "Scan scaling at " << largest << " orders" << Qt::endl;
+    benchmarkScaling(largest);
+
+    out() << Qt::endl << "Persistence" << Qt::endl;
+    for (int count : std::as_const(counts)) {
+        benchmarkPersistence(count);
+    }
+    return 0;
+}
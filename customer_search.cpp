@@ -1,4 +1,9 @@
 #include "customer_search.h"
+#include "ordermanager.h"
+#include "customerfilterproxymodel.h"
+#include "customersearchengine.h"
+#include "searchhighlightdelegate.h"
+#include <QSignalBlocker>
 
 // CustomerAnalytics Implementation
 CustomerAnalytics::CustomerAnalytics(QObject *parent)
@@ -155,6 +160,7 @@ CustomerSearch::CustomerSearch(QWidget *parent)
     : QMainWindow(parent),
       m_analytics(std::make_unique<CustomerAnalytics>(this)),
       m_dataSync(std::make_unique<CustomerDataSync>(this)),
+      m_searchEngine(std::make_unique<CustomerSearchEngine>()),
       m_realTimeSyncEnabled(false)
 {
     setupUI();
@@ -287,9 +293,17 @@ void CustomerSearch::setupSearchPanel()
     spentLayout->addWidget(m_maxSpentSpin);
     advancedLayout->addRow(tr("Total Spent:"), spentLayout);
 
+    // The range is off until the user ticks it, otherwise the default
+    // one-year window would hide customers with older or no orders
     QHBoxLayout *dateLayout = new QHBoxLayout();
+    m_dateRangeCheck = new QCheckBox();
     m_fromDateEdit = new QDateEdit(QDate::currentDate().addYears(-1));
     m_toDateEdit = new QDateEdit(QDate::currentDate());
+    m_fromDateEdit->setEnabled(false);
+    m_toDateEdit->setEnabled(false);
+    connect(m_dateRangeCheck, &QCheckBox::toggled, m_fromDateEdit, &QWidget::setEnabled);
+    connect(m_dateRangeCheck, &QCheckBox::toggled, m_toDateEdit, &QWidget::setEnabled);
+    dateLayout->addWidget(m_dateRangeCheck);
     dateLayout->addWidget(m_fromDateEdit);
     dateLayout->addWidget(new QLabel("-"));
     dateLayout->addWidget(m_toDateEdit);
@@ -298,6 +312,10 @@ void CustomerSearch::setupSearchPanel()
     m_exactMatchCheck = new QCheckBox(tr("Exact match"));
     advancedLayout->addRow(m_exactMatchCheck);
 
+    m_fuzzyMatchCheck = new QCheckBox(tr("Tolerate typos"));
+    m_fuzzyMatchCheck->setToolTip(tr("Rank the closest names, emails and companies"));
+    advancedLayout->addRow(m_fuzzyMatchCheck);
+
     layout->addWidget(advancedGroup);
 
     // Action buttons
@@ -318,17 +336,23 @@ void CustomerSearch::setupResultsTable()
 {
     m_resultsTable = new QTableView();
     m_resultsModel = new QStandardItemModel(0, 10, this);
-    m_proxyModel = new QSortFilterProxyModel(this);
+    m_proxyModel = new CustomerFilterProxyModel(this);
 
     m_resultsModel->setHorizontalHeaderLabels({
         "ID", "Name", "Email", "Phone", "Company",
         "Segment", "Total Spent", "Orders", "Last Order", "Status"
     });
 
+    m_proxyModel->setCustomers(&m_customers);
     m_proxyModel->setSourceModel(m_resultsModel);
-    m_proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
     m_resultsTable->setModel(m_proxyModel);
 
+    // ID, Name, Email, Phone and Company are the columns the search covers
+    m_highlightDelegate = new SearchHighlightDelegate(this);
+    for (int col = 0; col <= 4; ++col) {
+        m_resultsTable->setItemDelegateForColumn(col, m_highlightDelegate);
+    }
+
     m_resultsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_resultsTable->setAlternatingRowColors(true);
     m_resultsTable->setSortingEnabled(true);
@@ -442,11 +466,27 @@ void CustomerSearch::connectSignals()
     // Search signals
     connect(m_searchButton, &QPushButton::clicked, this, &CustomerSearch::performSearch);
     connect(m_searchEdit, &QLineEdit::returnPressed, this, &CustomerSearch::performSearch);
-    connect(m_searchEdit, &QLineEdit::textChanged, [this]() {
-        if (m_searchEdit->text().length() >= 3) {
-            performSearch();
+    connect(m_searchEdit, &QLineEdit::textChanged, [this](const QString& text) {
+        m_searchEngine->search(text, searchMode());
+    });
+
+    // Exact and fuzzy matching exclude each other
+    connect(m_exactMatchCheck, &QCheckBox::toggled, [this](bool checked) {
+        if (checked) {
+            const QSignalBlocker blocker(m_fuzzyMatchCheck);
+            m_fuzzyMatchCheck->setChecked(false);
+        }
+        performSearch();
+    });
+    connect(m_fuzzyMatchCheck, &QCheckBox::toggled, [this](bool checked) {
+        if (checked) {
+            const QSignalBlocker blocker(m_exactMatchCheck);
+            m_exactMatchCheck->setChecked(false);
         }
+        performSearch();
     });
+    connect(m_searchEngine.get(), &CustomerSearchEngine::matchesReady,
+            this, &CustomerSearch::showSearchResults);
 
     connect(m_advancedSearchButton, &QPushButton::clicked,
             this, &CustomerSearch::performAdvancedSearch);
@@ -458,6 +498,8 @@ void CustomerSearch::connectSignals()
             this, &CustomerSearch::applySearchCriteria);
     connect(m_countryFilter, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &CustomerSearch::applySearchCriteria);
+    connect(m_dateRangeCheck, &QCheckBox::toggled,
+            this, &CustomerSearch::applySearchCriteria);
 
     // Analytics signals
     connect(m_analytics.get(), &CustomerAnalytics::analysisCompleted, [this]() {
@@ -543,23 +585,38 @@ void CustomerSearch::loadCustomers()
     double retentionRate = m_customers.empty() ? 0 :
         (activeCount * 100.0 / m_customers.size());
     m_retentionRateLabel->setText(QString("%1%").arg(retentionRate, 0, 'f', 1));
+
+    m_searchEngine->setCustomers(m_customers);
 }
 
 void CustomerSearch::performSearch()
 {
-    QString searchText = m_searchEdit->text().toLower();
+    m_searchEngine->searchNow(m_searchEdit->text(), searchMode());
+}
 
-    if (searchText.isEmpty()) {
-        m_proxyModel->setFilterRegularExpression("");
-        return;
+CustomerSearchMode CustomerSearch::searchMode() const
+{
+    if (m_exactMatchCheck->isChecked()) return CustomerSearchMode::Exact;
+    if (m_fuzzyMatchCheck->isChecked()) return CustomerSearchMode::Fuzzy;
+    return CustomerSearchMode::Substring;
+}
+
+void CustomerSearch::showSearchResults(const CustomerMatches& matches)
+{
+    m_currentCriteria.textSearch = matches.text;
+    m_currentCriteria.exactMatch = matches.mode == CustomerSearchMode::Exact;
+    m_currentCriteria.fuzzyMatch = matches.mode == CustomerSearchMode::Fuzzy;
+    m_proxyModel->setCriteria(m_currentCriteria, &matches);
+
+    // Ranked results only show their order while the view is sorted
+    if (matches.mode == CustomerSearchMode::Fuzzy && m_proxyModel->sortColumn() < 0) {
+        m_resultsTable->sortByColumn(0, Qt::AscendingOrder);
     }
 
-    // Custom filter that searches across multiple columns
-    m_proxyModel->setFilterRegularExpression(QRegularExpression(searchText,
-        QRegularExpression::CaseInsensitiveOption));
-    m_proxyModel->setFilterKeyColumn(-1); // Search all columns
+    m_highlightDelegate->setQuery(matches.text, matches.mode);
+    m_resultsTable->viewport()->update();
 
-    highlightSearchResults();
+    if (matches.text.isEmpty()) return;
 
     int resultCount = m_proxyModel->rowCount();
     statusBar()->showMessage(tr("Found %1 customers").arg(resultCount), 3000);
@@ -572,8 +629,16 @@ void CustomerSearch::performAdvancedSearch()
     dialog.setSearchCriteria(m_currentCriteria);
 
     if (dialog.exec() == QDialog::Accepted) {
-        m_currentCriteria = dialog.getSearchCriteria();
-        applySearchCriteria();
+        // The dialog has no status, tag or match mode controls, and its
+        // condition list is descriptive text rather than a keyword, so those
+        // are kept from the current search
+        SearchCriteria criteria = dialog.getSearchCriteria();
+        criteria.textSearch = m_searchEdit->text();
+        criteria.status = m_currentCriteria.status;
+        criteria.tags = m_currentCriteria.tags;
+        criteria.exactMatch = m_currentCriteria.exactMatch;
+        criteria.fuzzyMatch = m_currentCriteria.fuzzyMatch;
+        setSearchCriteria(criteria);
     }
 }
 
@@ -585,34 +650,32 @@ void CustomerSearch::clearSearch()
     m_countryFilter->setCurrentIndex(0);
     m_minSpentSpin->setValue(0);
     m_maxSpentSpin->setValue(1000000);
+    m_dateRangeCheck->setChecked(false);
     m_fromDateEdit->setDate(QDate::currentDate().addYears(-1));
     m_toDateEdit->setDate(QDate::currentDate());
     m_exactMatchCheck->setChecked(false);
+    m_fuzzyMatchCheck->setChecked(false);
 
-    m_proxyModel->setFilterRegularExpression("");
+    m_currentCriteria = SearchCriteria();
+    m_proxyModel->setCriteria(m_currentCriteria);
     statusBar()->showMessage(tr("Search cleared"), 2000);
 }
 
 void CustomerSearch::applySearchCriteria()
 {
-    // Apply complex filtering based on all criteria
-    // This is a simplified version - in production, you'd implement custom QSortFilterProxyModel
-
-    QString status = m_statusFilter->currentText();
-    QString segment = m_segmentFilter->currentText();
-    QString country = m_countryFilter->currentText();
-
-    // Build filter expression
-    QString filter;
-    if (status != "All") {
-        filter = status;
-    }
+    // The panel widgets win; city, orders, satisfaction and tags only come
+    // from the advanced search dialog and are kept from m_currentCriteria.
+    // The text is left alone, it changes when the search engine publishes.
+    m_currentCriteria.status = m_statusFilter->currentText();
+    m_currentCriteria.segment = m_segmentFilter->currentText();
+    m_currentCriteria.country = m_countryFilter->currentText();
+    m_currentCriteria.minSpent = m_minSpentSpin->value();
+    m_currentCriteria.maxSpent = m_maxSpentSpin->value() < m_maxSpentSpin->maximum()
+        ? m_maxSpentSpin->value() : 0;
+    m_currentCriteria.fromDate = m_dateRangeCheck->isChecked() ? m_fromDateEdit->date() : QDate();
+    m_currentCriteria.toDate = m_dateRangeCheck->isChecked() ? m_toDateEdit->date() : QDate();
 
-    // Apply filter
-    if (!filter.isEmpty()) {
-        m_proxyModel->setFilterKeyColumn(9); // Status column
-        m_proxyModel->setFilterFixedString(filter);
-    }
+    m_proxyModel->setCriteria(m_currentCriteria);
 
     int resultCount = m_proxyModel->rowCount();
     statusBar()->showMessage(tr("Filtered: %1 customers").arg(resultCount), 3000);
@@ -692,6 +755,7 @@ void CustomerSearch::importCustomers()
             customer.status = fields[9];
 
             m_customers.push_back(customer);
+            m_searchEngine->insertCustomer(customer);
 
             // Add to model
             QList<QStandardItem*> items;
@@ -764,6 +828,7 @@ void CustomerSearch::deleteCustomer()
         // Update analytics
         m_analytics->analyzeCustomers(m_customers);
         m_totalCustomersLabel->setText(QString::number(m_customers.size()));
+        m_searchEngine->removeCustomer(customerId);
 
         statusBar()->showMessage(tr("Customer %1 deleted").arg(customerName), 3000);
     }
@@ -805,7 +870,7 @@ void CustomerSearch::createCustomer()
 
 void CustomerSearch::showAnalytics()
 {
-    CustomerAnalyticsDashboard dashboard(m_customers, this);
+    CustomerAnalyticsDashboard dashboard(m_customers, m_orderManager, this);
     dashboard.exec();
 }
 
@@ -829,6 +894,7 @@ void CustomerSearch::handleCustomerUpdate(const Customer& customer)
     if (it != m_customers.end()) {
         *it = customer;
         updateCustomerInModel(customer);
+        m_searchEngine->insertCustomer(customer);
     }
 }
 
@@ -930,38 +996,45 @@ void CustomerSearch::viewCommunicationHistory()
     dialog.exec();
 }
 
-void CustomerSearch::highlightSearchResults()
-{
-    QString searchText = m_searchEdit->text();
-    if (searchText.isEmpty()) return;
-
-    // Highlight matching cells
-    for (int row = 0; row < m_proxyModel->rowCount(); ++row) {
-        for (int col = 0; col < m_proxyModel->columnCount(); ++col) {
-            QModelIndex proxyIndex = m_proxyModel->index(row, col);
-            QModelIndex sourceIndex = m_proxyModel->mapToSource(proxyIndex);
-
-            QString cellText = m_proxyModel->data(proxyIndex).toString();
-            if (cellText.contains(searchText, Qt::CaseInsensitive)) {
-                m_resultsModel->itemFromIndex(sourceIndex)->setBackground(
-                    QColor(241, 196, 15, 50));
-            }
-        }
-    }
-}
-
 void CustomerSearch::setSearchCriteria(const SearchCriteria& criteria)
 {
+    const CustomerSearchMode mode = CustomerFilterProxyModel::searchModeOf(criteria);
+
+    // The filters apply at once; the text follows when its search finishes
     m_currentCriteria = criteria;
+    m_currentCriteria.textSearch = m_proxyModel->criteria().textSearch;
+    m_currentCriteria.exactMatch = m_proxyModel->criteria().exactMatch;
+    m_currentCriteria.fuzzyMatch = m_proxyModel->criteria().fuzzyMatch;
+
+    // One refilter at the end instead of one per widget
+    const QSignalBlocker statusBlocker(m_statusFilter);
+    const QSignalBlocker segmentBlocker(m_segmentFilter);
+    const QSignalBlocker countryBlocker(m_countryFilter);
+    const QSignalBlocker searchBlocker(m_searchEdit);
+    const QSignalBlocker exactBlocker(m_exactMatchCheck);
+    const QSignalBlocker fuzzyBlocker(m_fuzzyMatchCheck);
+    const QSignalBlocker dateRangeBlocker(m_dateRangeCheck);
+    m_statusFilter->setCurrentText(criteria.status.isEmpty() ? "All" : criteria.status);
+    m_segmentFilter->setCurrentText(criteria.segment.isEmpty() ? "All" : criteria.segment);
+    m_countryFilter->setCurrentText(criteria.country.isEmpty() ? "All" : criteria.country);
 
     m_searchEdit->setText(criteria.textSearch);
     m_minSpentSpin->setValue(criteria.minSpent);
-    m_maxSpentSpin->setValue(criteria.maxSpent);
-    m_fromDateEdit->setDate(criteria.fromDate);
-    m_toDateEdit->setDate(criteria.toDate);
-    m_exactMatchCheck->setChecked(criteria.exactMatch);
+    m_maxSpentSpin->setValue(criteria.maxSpent > 0 ? criteria.maxSpent : m_maxSpentSpin->maximum());
+    // Blocked signals skip the enable connections, so sync the edits by hand
+    const bool dateRange = criteria.fromDate.isValid() || criteria.toDate.isValid();
+    m_dateRangeCheck->setChecked(dateRange);
+    m_fromDateEdit->setEnabled(dateRange);
+    m_toDateEdit->setEnabled(dateRange);
+    if (criteria.fromDate.isValid())
+        m_fromDateEdit->setDate(criteria.fromDate);
+    if (criteria.toDate.isValid())
+        m_toDateEdit->setDate(criteria.toDate);
+    m_exactMatchCheck->setChecked(mode == CustomerSearchMode::Exact);
+    m_fuzzyMatchCheck->setChecked(mode == CustomerSearchMode::Fuzzy);
 
     applySearchCriteria();
+    m_searchEngine->searchNow(criteria.textSearch, mode);
 }
 
 // CustomerDetailsDialog Implementation
@@ -1191,8 +1264,14 @@ void AdvancedSearchDialog::setupUI()
     m_minSatisfactionSpin->setSingleStep(0.1);
 
     QHBoxLayout *activityLayout = new QHBoxLayout();
+    m_lastActivityCheck = new QCheckBox();
     m_lastActivityFromEdit = new QDateEdit(QDate::currentDate().addYears(-1));
     m_lastActivityToEdit = new QDateEdit(QDate::currentDate());
+    m_lastActivityFromEdit->setEnabled(false);
+    m_lastActivityToEdit->setEnabled(false);
+    connect(m_lastActivityCheck, &QCheckBox::toggled, m_lastActivityFromEdit, &QWidget::setEnabled);
+    connect(m_lastActivityCheck, &QCheckBox::toggled, m_lastActivityToEdit, &QWidget::setEnabled);
+    activityLayout->addWidget(m_lastActivityCheck);
     activityLayout->addWidget(m_lastActivityFromEdit);
     activityLayout->addWidget(new QLabel("-"));
     activityLayout->addWidget(m_lastActivityToEdit);
@@ -1274,8 +1353,10 @@ SearchCriteria AdvancedSearchDialog::getSearchCriteria() const
     criteria.maxSpent = m_maxSpentSpin->value();
     criteria.minOrders = m_minOrdersSpin->value();
     criteria.minSatisfaction = m_minSatisfactionSpin->value();
-    criteria.fromDate = m_lastActivityFromEdit->date();
-    criteria.toDate = m_lastActivityToEdit->date();
+    if (m_lastActivityCheck->isChecked()) {
+        criteria.fromDate = m_lastActivityFromEdit->date();
+        criteria.toDate = m_lastActivityToEdit->date();
+    }
 
     return criteria;
 }
@@ -1287,11 +1368,14 @@ void AdvancedSearchDialog::setSearchCriteria(const SearchCriteria& criteria)
     m_cityCombo->setCurrentText(criteria.city);
     m_segmentCombo->setCurrentText(criteria.segment);
     m_minSpentSpin->setValue(criteria.minSpent);
-    m_maxSpentSpin->setValue(criteria.maxSpent);
+    m_maxSpentSpin->setValue(criteria.maxSpent > 0 ? criteria.maxSpent : m_maxSpentSpin->maximum());
     m_minOrdersSpin->setValue(criteria.minOrders);
     m_minSatisfactionSpin->setValue(criteria.minSatisfaction);
-    m_lastActivityFromEdit->setDate(criteria.fromDate);
-    m_lastActivityToEdit->setDate(criteria.toDate);
+    m_lastActivityCheck->setChecked(criteria.fromDate.isValid() || criteria.toDate.isValid());
+    if (criteria.fromDate.isValid())
+        m_lastActivityFromEdit->setDate(criteria.fromDate);
+    if (criteria.toDate.isValid())
+        m_lastActivityToEdit->setDate(criteria.toDate);
 }
 
 // CustomerMergeDialog Implementation
@@ -1530,14 +1614,16 @@ void CommunicationHistoryDialog::filterByDate()
 
 // CustomerAnalyticsDashboard Implementation
 CustomerAnalyticsDashboard::CustomerAnalyticsDashboard(const std::vector<Customer>& customers,
+                                                     const OrderManager* orderManager,
                                                      QWidget *parent)
-    : QDialog(parent), m_customers(customers)
+    : QDialog(parent), m_customers(customers), m_orderManager(orderManager)
 {
     setWindowTitle(tr("Customer Analytics Dashboard"));
     setModal(true);
     resize(1200, 800);
     setupUI();
     updateMetrics();
+    updateRevenueRollup();
     generateCharts();
 }
 
@@ -1653,6 +1739,14 @@ void CustomerAnalyticsDashboard::setupUI()
     m_revenueChart->setMinimumHeight(500);
     revenueLayout->addWidget(m_revenueChart);
 
+    m_revenueTable = new QTableWidget();
+    m_revenueTable->setColumnCount(3);
+    m_revenueTable->setHorizontalHeaderLabels({"Period", "Orders", "Revenue"});
+    m_revenueTable->horizontalHeader()->setStretchLastSection(true);
+    revenueLayout->addWidget(m_revenueTable);
+    connect(m_periodCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &CustomerAnalyticsDashboard::updateRevenueRollup);
+
     m_tabWidget->addTab(revenueTab, tr("Revenue Analysis"));
 
     // Satisfaction Metrics tab
@@ -1761,6 +1855,46 @@ void CustomerAnalyticsDashboard::updateMetrics()
     }
 }
 
+void CustomerAnalyticsDashboard::updateRevenueRollup()
+{
+    m_revenueTable->setRowCount(0);
+    if (!m_orderManager) return;
+
+    // The combo lists the periods in OrderRollup::Period order
+    const auto period = static_cast<OrderRollup::Period>(m_periodCombo->currentIndex());
+    const QList<OrderRollup::Bucket> buckets = m_orderManager->getRevenueRollup(period);
+
+    m_revenueTable->setRowCount(buckets.size());
+    for (int row = 0; row < buckets.size(); ++row) {
+        const OrderRollup::Bucket& bucket = buckets[row];
+        QString label;
+        switch (period) {
+        case OrderRollup::Day:
+            label = bucket.start.toString("yyyy-MM-dd");
+            break;
+        case OrderRollup::Week: {
+            int weekYear = 0;
+            const int week = bucket.start.weekNumber(&weekYear);
+            label = QString("%1-W%2").arg(weekYear).arg(week, 2, 10, QChar('0'));
+            break;
+        }
+        case OrderRollup::Month:
+            label = bucket.start.toString("yyyy-MM");
+            break;
+        case OrderRollup::Quarter:
+            label = QString("%1-Q%2").arg(bucket.start.year()).arg((bucket.start.month() - 1) / 3 + 1);
+            break;
+        default:
+            label = QString::number(bucket.start.year());
+            break;
+        }
+
+        m_revenueTable->setItem(row, 0, new QTableWidgetItem(label));
+        m_revenueTable->setItem(row, 1, new QTableWidgetItem(QString::number(bucket.count)));
+        m_revenueTable->setItem(row, 2, new QTableWidgetItem(QString("$%1").arg(bucket.revenue, 0, 'f', 2)));
+    }
+}
+
 void CustomerAnalyticsDashboard::generateCharts()
 {
     // In a real implementation, you would use QtCharts or another charting library
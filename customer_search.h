@@ -48,6 +48,13 @@
 #include <QtAlgorithms>
 #include <QMap>
 
+class OrderManager;
+class CustomerFilterProxyModel;
+class CustomerSearchEngine;
+class SearchHighlightDelegate;
+struct CustomerMatches;
+enum class CustomerSearchMode;
+
 // Customer data structure
 struct Customer {
     QString id;
@@ -78,14 +85,15 @@ struct SearchCriteria {
     QString segment;
     QString city;
     QString country;
-    double minSpent;
-    double maxSpent;
+    double minSpent = 0;
+    double maxSpent = 0; // 0 = no upper bound
     QDate fromDate;
     QDate toDate;
-    int minOrders;
-    double minSatisfaction;
+    int minOrders = 0;
+    double minSatisfaction = 0;
     QStringList tags;
-    bool exactMatch;
+    bool exactMatch = false;
+    bool fuzzyMatch = false; // typo tolerant, ranked; exactMatch wins over it
 };
 
 // Customer Analytics
@@ -143,6 +151,7 @@ public:
 
     void loadCustomers();
     void setSearchCriteria(const SearchCriteria& criteria);
+    void setOrderManager(OrderManager* orderManager) { m_orderManager = orderManager; }
 
 public slots:
     // Search operations
@@ -185,13 +194,15 @@ private:
     void setupToolBar();
     void connectSignals();
     void applySearchCriteria();
+    void showSearchResults(const CustomerMatches& matches);
+    CustomerSearchMode searchMode() const;
     void updateCustomerInModel(const Customer& customer);
-    void highlightSearchResults();
 
     // UI Components
     QTableView *m_resultsTable;
     QStandardItemModel *m_resultsModel;
-    QSortFilterProxyModel *m_proxyModel;
+    CustomerFilterProxyModel *m_proxyModel;
+    SearchHighlightDelegate *m_highlightDelegate;
 
     // Search controls
     QLineEdit *m_searchEdit;
@@ -200,9 +211,11 @@ private:
     QComboBox *m_countryFilter;
     QSpinBox *m_minSpentSpin;
     QSpinBox *m_maxSpentSpin;
+    QCheckBox *m_dateRangeCheck;
     QDateEdit *m_fromDateEdit;
     QDateEdit *m_toDateEdit;
     QCheckBox *m_exactMatchCheck;
+    QCheckBox *m_fuzzyMatchCheck;
     QPushButton *m_searchButton;
     QPushButton *m_advancedSearchButton;
 
@@ -218,7 +231,9 @@ private:
     std::vector<Customer> m_customers;
     std::unique_ptr<CustomerAnalytics> m_analytics;
     std::unique_ptr<CustomerDataSync> m_dataSync;
+    std::unique_ptr<CustomerSearchEngine> m_searchEngine;
     SearchCriteria m_currentCriteria;
+    OrderManager* m_orderManager = nullptr; // optional, feeds the revenue analysis
 
     // Real-time sync
     bool m_realTimeSyncEnabled;
@@ -297,6 +312,7 @@ private:
     QSpinBox *m_minOrdersSpin;
     QSpinBox *m_maxOrdersSpin;
     QDoubleSpinBox *m_minSatisfactionSpin;
+    QCheckBox *m_lastActivityCheck;
     QDateEdit *m_lastActivityFromEdit;
     QDateEdit *m_lastActivityToEdit;
 
@@ -355,15 +371,18 @@ class CustomerAnalyticsDashboard : public QDialog {
     Q_OBJECT
 public:
     explicit CustomerAnalyticsDashboard(const std::vector<Customer>& customers,
+                                        const OrderManager* orderManager = nullptr,
                                         QWidget *parent = nullptr);
 
 private:
     void setupUI();
     void generateCharts();
     void updateMetrics();
+    void updateRevenueRollup();
     void exportAnalytics();
 
     std::vector<Customer> m_customers;
+    const OrderManager* m_orderManager;
     QTabWidget *m_tabWidget;
 
     // Overview tab
@@ -384,6 +403,7 @@ private:
     // Revenue analysis tab
     QWidget *m_revenueChart;
     QComboBox *m_periodCombo;
+    QTableWidget *m_revenueTable;
 
     // Satisfaction metrics tab
     QWidget *m_satisfactionChart;
@@ -0,0 +1,138 @@
+#include "customerfilterproxymodel.h"
+
+namespace {
+
+// Filter value with "All" (the combo default) folded to "no filter"
+QString filterValue(const QString& value)
+{
+    const QString trimmed = value.trimmed();
+    return trimmed.compare("All", Qt::CaseInsensitive) == 0 ? QString() : trimmed;
+}
+
+bool sameText(const QString& a, const QString& b)
+{
+    return a.compare(b, Qt::CaseInsensitive) == 0;
+}
+
+} // namespace
+
+CustomerFilterProxyModel::CustomerFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+}
+
+void CustomerFilterProxyModel::setCustomers(const std::vector<Customer>* customers)
+{
+    m_customers = customers;
+    invalidateFilter();
+}
+
+void CustomerFilterProxyModel::setCriteria(const SearchCriteria& criteria, const CustomerMatches* matches)
+{
+    m_criteria = criteria;
+    if (matches) {
+        m_matches = *matches;
+    }
+
+    m_text = criteria.textSearch.trimmed();
+    m_status = filterValue(criteria.status);
+    m_segment = filterValue(criteria.segment);
+    m_country = filterValue(criteria.country);
+    m_city = filterValue(criteria.city);
+    m_from = criteria.fromDate.isValid() ? criteria.fromDate.startOfDay() : QDateTime();
+    m_to = criteria.toDate.isValid() ? criteria.toDate.addDays(1).startOfDay() : QDateTime();
+
+    // New matches may bring a new ranking, which needs a re-sort as well
+    if (matches) {
+        invalidate();
+    } else {
+        invalidateFilter();
+    }
+}
+
+CustomerSearchMode CustomerFilterProxyModel::searchModeOf(const SearchCriteria& criteria)
+{
+    if (criteria.exactMatch) return CustomerSearchMode::Exact;
+    if (criteria.fuzzyMatch) return CustomerSearchMode::Fuzzy;
+    return CustomerSearchMode::Substring;
+}
+
+bool CustomerFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    if (sourceParent.isValid() || !m_customers) return true;
+    if (sourceRow < 0 || sourceRow >= static_cast<int>(m_customers->size())) return false;
+
+    return accepts((*m_customers)[sourceRow]);
+}
+
+bool CustomerFilterProxyModel::accepts(const Customer& customer) const
+{
+    // Cheapest tests first so most rejections never touch a string
+    if (customer.totalSpent < m_criteria.minSpent) return false;
+    if (m_criteria.maxSpent > 0 && customer.totalSpent > m_criteria.maxSpent) return false;
+    if (customer.orderCount < m_criteria.minOrders) return false;
+    if (customer.satisfactionScore < m_criteria.minSatisfaction) return false;
+
+    if (m_from.isValid() || m_to.isValid()) {
+        if (!customer.lastOrderDate.isValid()) return false;
+        if (m_from.isValid() && customer.lastOrderDate < m_from) return false;
+        if (m_to.isValid() && customer.lastOrderDate >= m_to) return false;
+    }
+
+    if (!m_status.isEmpty() && !sameText(customer.status, m_status)) return false;
+    if (!m_segment.isEmpty() && !sameText(customer.segment, m_segment)) return false;
+    if (!m_country.isEmpty() && !sameText(customer.country, m_country)) return false;
+    if (!m_city.isEmpty() && !sameText(customer.city, m_city)) return false;
+
+    for (const QString& tag : m_criteria.tags) {
+        if (!customer.tags.contains(tag, Qt::CaseInsensitive)) return false;
+    }
+
+    return m_text.isEmpty() || matchesText(customer);
+}
+
+bool CustomerFilterProxyModel::matchesText(const Customer& customer) const
+{
+    if (m_matches.answers(m_text, searchModeOf(m_criteria))) {
+        return m_matches.ids.contains(customer.id);
+    }
+
+    // Without published matches a fuzzy query degrades to a substring scan
+
+    const QString* fields[] = {
+        &customer.id, &customer.name, &customer.email, &customer.phone, &customer.company
+    };
+
+    for (const QString* field : fields) {
+        if (m_criteria.exactMatch ? sameText(*field, m_text)
+                                  : field->contains(m_text, Qt::CaseInsensitive)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CustomerFilterProxyModel::isRanked() const
+{
+    return !m_text.isEmpty() && !m_matches.ranks.isEmpty()
+        && m_matches.answers(m_text, searchModeOf(m_criteria));
+}
+
+bool CustomerFilterProxyModel::lessThan(const QModelIndex& sourceLeft, const QModelIndex& sourceRight) const
+{
+    if (!isRanked() || !m_customers) {
+        return QSortFilterProxyModel::lessThan(sourceLeft, sourceRight);
+    }
+
+    const int size = static_cast<int>(m_customers->size());
+    if (sourceLeft.row() >= size || sourceRight.row() >= size) {
+        return QSortFilterProxyModel::lessThan(sourceLeft, sourceRight);
+    }
+
+    const int left = m_matches.ranks.value((*m_customers)[sourceLeft.row()].id, m_matches.ranks.size());
+    const int right = m_matches.ranks.value((*m_customers)[sourceRight.row()].id, m_matches.ranks.size());
+
+    // The view reverses the result for a descending sort; undo that so the
+    // best match stays on top
+    return sortOrder() == Qt::AscendingOrder ? left < right : left > right;
+}
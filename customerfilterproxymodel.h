@@ -0,0 +1,56 @@
+#ifndef CUSTOMERFILTERPROXYMODEL_H
+#define CUSTOMERFILTERPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QDateTime>
+#include <vector>
+#include "customer_search.h"
+#include "customersearchengine.h"
+
+// Filters the customer results table on the typed Customer fields instead of
+// the formatted cell text. Source row N must be customers[N]; CustomerSearch
+// keeps its model and m_customers in step for that reason.
+class CustomerFilterProxyModel : public QSortFilterProxyModel {
+    Q_OBJECT
+
+public:
+    explicit CustomerFilterProxyModel(QObject *parent = nullptr);
+
+    void setCustomers(const std::vector<Customer>* customers);
+
+    // Empty strings and "All" disable a field, as do a zero maxSpent and
+    // invalid dates. Every field that is set must match. Text is looked up in
+    // matches when they answer criteria.textSearch, and scanned otherwise;
+    // passing new matches replaces the kept ones in the same refilter.
+    void setCriteria(const SearchCriteria& criteria, const CustomerMatches* matches = nullptr);
+    const SearchCriteria& criteria() const { return m_criteria; }
+
+    static CustomerSearchMode searchModeOf(const SearchCriteria& criteria);
+
+    bool accepts(const Customer& customer) const;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    // Fuzzy results keep their ranking, best first, whatever the sort column
+    bool lessThan(const QModelIndex& sourceLeft, const QModelIndex& sourceRight) const override;
+
+private:
+    bool matchesText(const Customer& customer) const;
+    bool isRanked() const;
+
+    const std::vector<Customer>* m_customers = nullptr;
+    SearchCriteria m_criteria;
+    CustomerMatches m_matches;
+
+    // Derived from m_criteria once per setCriteria() so the per-row test
+    // only compares values
+    QString m_text;
+    QString m_status;
+    QString m_segment;
+    QString m_country;
+    QString m_city;
+    QDateTime m_from;
+    QDateTime m_to; // exclusive
+};
+
+#endif // CUSTOMERFILTERPROXYMODEL_H
@@ -0,0 +1,289 @@
+#include "customersearchengine.h"
+#include <algorithm>
+
+namespace {
+
+// Field positions in the indexed text, see searchTextOf()
+enum Field { IdField = 1, NameField, EmailField, PhoneField, CompanyField };
+
+// Candidates verified per fuzzy query, best trigram overlap first
+constexpr int FuzzyCandidates = 2000;
+
+// Smallest edit distance between needle and any substring of haystack, so a
+// query only has to resemble part of a field ("jon" is 1 from "john smith")
+int substringDistance(const QString& needle, const QString& haystack)
+{
+    std::vector<int> column(needle.size() + 1);
+    for (qsizetype i = 0; i <= needle.size(); ++i) {
+        column[i] = int(i);
+    }
+
+    int best = column.back();
+    for (QChar c : haystack) {
+        int diagonal = column[0];
+        column[0] = 0; // a match may start anywhere in the haystack
+        for (qsizetype i = 1; i <= needle.size(); ++i) {
+            const int previous = column[i];
+            column[i] = std::min({column[i] + 1, column[i - 1] + 1,
+                                  diagonal + (needle[i - 1] == c ? 0 : 1)});
+            diagonal = previous;
+        }
+        best = std::min(best, column.back());
+    }
+    return best;
+}
+
+// Ranks customers by their closest name, email or company. The trigram index
+// proposes the candidates; each edit breaks at most three of the query's
+// trigrams, which bounds how few a real match can share.
+CustomerMatches fuzzyMatches(const TrigramIndex& index, const QString& text,
+                             const std::atomic<bool>& cancelled)
+{
+    CustomerMatches result;
+    result.text = text;
+    result.mode = CustomerSearchMode::Fuzzy;
+
+    const QString needle = text.toLower();
+    QStringList ranked;
+
+    if (needle.size() < 3) {
+        // Too short to have trigrams or to carry a typo
+        ranked = index.search(needle, &cancelled).mid(0, CustomerSearchEngine::FuzzyLimit);
+    } else {
+        const int maxDistance = qMax(1, int(needle.size() / 4));
+        const int minShared = qMax(1, int(needle.size() - 2) - 3 * maxDistance);
+
+        struct Scored {
+            int distance;
+            int shared;
+            QString key;
+        };
+        std::vector<Scored> scored;
+
+        for (const auto& [key, shared] : index.similar(needle, minShared, FuzzyCandidates, &cancelled)) {
+            if (cancelled) return result;
+
+            const QStringList fields = index.text(key).split(QLatin1Char('\n'));
+            if (fields.size() <= CompanyField) continue;
+
+            int distance = maxDistance + 1;
+            for (int field : {NameField, EmailField, CompanyField}) {
+                distance = qMin(distance, substringDistance(needle, fields[field]));
+            }
+            if (distance <= maxDistance) {
+                scored.push_back({distance, shared, key});
+            }
+        }
+
+        const size_t count = qMin(scored.size(), size_t(CustomerSearchEngine::FuzzyLimit));
+        std::partial_sort(scored.begin(), scored.begin() + count, scored.end(),
+                          [](const Scored& a, const Scored& b) {
+            if (a.distance != b.distance) return a.distance < b.distance;
+            if (a.shared != b.shared) return a.shared > b.shared;
+            return a.key < b.key;
+        });
+        for (size_t i = 0; i < count; ++i) {
+            ranked.append(scored[i].key);
+        }
+    }
+
+    result.ids.reserve(ranked.size());
+    result.ranks.reserve(ranked.size());
+    for (int i = 0; i < ranked.size(); ++i) {
+        result.ids.insert(ranked[i]);
+        result.ranks.insert(ranked[i], i);
+    }
+    return result;
+}
+
+} // namespace
+
+CustomerSearchEngine::CustomerSearchEngine(QObject *parent)
+    : QObject(parent),
+      m_index(std::make_shared<TrigramIndex>())
+{
+    m_pool.setMaxThreadCount(1);
+
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DebounceMsecs);
+    connect(&m_debounce, &QTimer::timeout, this, &CustomerSearchEngine::start);
+}
+
+CustomerSearchEngine::~CustomerSearchEngine()
+{
+    // The worker posts its result back to this object, so it must be done first
+    cancel();
+    m_pool.waitForDone();
+}
+
+// Fields are framed by newlines, which a typed query cannot contain, so a
+// substring query never matches across two fields
+QString CustomerSearchEngine::searchTextOf(const Customer& customer)
+{
+    return QLatin1Char('\n') + customer.id + QLatin1Char('\n') + customer.name
+         + QLatin1Char('\n') + customer.email + QLatin1Char('\n') + customer.phone
+         + QLatin1Char('\n') + customer.company + QLatin1Char('\n');
+}
+
+// Text the index will hold for the customer once pending changes are applied
+QString CustomerSearchEngine::currentText(const QString& customerId) const
+{
+    auto pending = m_pending.constFind(customerId);
+    return pending != m_pending.constEnd() ? pending.value() : m_index->text(customerId);
+}
+
+void CustomerSearchEngine::applyPendingChanges()
+{
+    // Only this thread hands out references, so a count of one cannot grow
+    // behind our back. Otherwise the last query to finish calls back here.
+    if (m_pending.isEmpty() || m_index.use_count() > 1) return;
+
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (it.value().isNull()) {
+            m_index->remove(it.key());
+        } else {
+            m_index->insert(it.key(), it.value());
+        }
+    }
+    m_pending.clear();
+    indexChanged();
+}
+
+void CustomerSearchEngine::addExactKeys(const QString& customerId, const QString& text)
+{
+    for (const QString& field : text.split(QLatin1Char('\n'), Qt::SkipEmptyParts)) {
+        m_exactIndex[field].insert(customerId);
+    }
+}
+
+void CustomerSearchEngine::removeExactKeys(const QString& customerId, const QString& text)
+{
+    for (const QString& field : text.split(QLatin1Char('\n'), Qt::SkipEmptyParts)) {
+        auto ids = m_exactIndex.find(field);
+        if (ids == m_exactIndex.end()) continue;
+
+        ids->remove(customerId);
+        if (ids->isEmpty()) {
+            m_exactIndex.erase(ids);
+        }
+    }
+}
+
+void CustomerSearchEngine::indexChanged()
+{
+    if (!m_text.isEmpty()) {
+        m_debounce.start();
+    }
+}
+
+void CustomerSearchEngine::setCustomers(const std::vector<Customer>& customers)
+{
+    // A fresh index replaces the old one outright, even if a query holds it
+    auto index = std::make_shared<TrigramIndex>();
+    index->reserve(static_cast<int>(customers.size()));
+    m_pending.clear();
+    m_exactIndex.clear();
+    for (const Customer& customer : customers) {
+        const QString text = searchTextOf(customer).toLower();
+        index->insert(customer.id, text);
+        addExactKeys(customer.id, text);
+    }
+    m_index = std::move(index);
+    indexChanged();
+}
+
+void CustomerSearchEngine::insertCustomer(const Customer& customer)
+{
+    removeExactKeys(customer.id, currentText(customer.id));
+
+    const QString text = searchTextOf(customer).toLower();
+    addExactKeys(customer.id, text);
+    m_pending.insert(customer.id, text);
+    applyPendingChanges();
+}
+
+void CustomerSearchEngine::removeCustomer(const QString& customerId)
+{
+    const QString text = currentText(customerId);
+    if (text.isNull()) return;
+
+    removeExactKeys(customerId, text);
+    m_pending.insert(customerId, QString());
+    applyPendingChanges();
+}
+
+void CustomerSearchEngine::search(const QString& text, CustomerSearchMode mode)
+{
+    m_text = text.trimmed();
+    m_mode = mode;
+
+    // Clearing the box needs no work, so it is not worth waiting for
+    if (m_text.isEmpty()) {
+        start();
+        return;
+    }
+    m_debounce.start();
+}
+
+void CustomerSearchEngine::searchNow(const QString& text, CustomerSearchMode mode)
+{
+    m_text = text.trimmed();
+    m_mode = mode;
+    start();
+}
+
+void CustomerSearchEngine::cancel()
+{
+    m_debounce.stop();
+    ++m_generation;
+    if (m_cancelled) {
+        *m_cancelled = true;
+        m_cancelled.reset();
+    }
+}
+
+void CustomerSearchEngine::start()
+{
+    cancel();
+    const quint64 generation = m_generation;
+
+    CustomerMatches result;
+    result.text = m_text;
+    result.mode = m_mode;
+    if (m_text.isEmpty()) {
+        emit matchesReady(result);
+        return;
+    }
+    if (m_mode == CustomerSearchMode::Exact) {
+        result.ids = m_exactIndex.value(m_text.toLower());
+        emit matchesReady(result);
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_cancelled = cancelled;
+
+    std::shared_ptr<const TrigramIndex> index = m_index;
+    m_pool.start([this, index, cancelled, generation, result]() mutable {
+        // The index checks the flag per chunk, so a superseded query gives
+        // up the pool thread quickly
+        if (!*cancelled) {
+            if (result.mode == CustomerSearchMode::Fuzzy) {
+                result = fuzzyMatches(*index, result.text, *cancelled);
+            } else {
+                const QStringList keys = index->search(result.text, cancelled.get());
+                result.ids = QSet<QString>(keys.begin(), keys.end());
+            }
+        }
+        const bool finished = !*cancelled;
+
+        // Let go of the index before the GUI thread looks at its use count
+        index.reset();
+        QMetaObject::invokeMethod(this, [this, generation, finished, result]() {
+            applyPendingChanges();
+            if (!finished || generation != m_generation) return; // superseded
+            m_cancelled.reset();
+            emit matchesReady(result);
+        }, Qt::QueuedConnection);
+    });
+}
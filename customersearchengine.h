@@ -0,0 +1,92 @@
+#ifndef CUSTOMERSEARCHENGINE_H
+#define CUSTOMERSEARCHENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "customer_search.h"
+#include "trigramindex.h"
+
+enum class CustomerSearchMode {
+    Substring,
+    Exact, // a whole field, ignoring case
+    Fuzzy  // typo tolerant, ranked best first
+};
+
+// Result of one text search: the ids of every matching customer
+struct CustomerMatches {
+    QString text;
+    CustomerSearchMode mode = CustomerSearchMode::Substring;
+    QSet<QString> ids;
+    QHash<QString, int> ranks; // fuzzy only: id -> place in the ranking, 0 is best
+
+    bool answers(const QString& query, CustomerSearchMode searchMode) const {
+        return text == query && mode == searchMode;
+    }
+};
+
+// Runs the quick search text against the customer list on a worker thread.
+// Keystrokes are debounced, a newer query cancels the one in flight, and
+// only the result of the latest query is ever published, in one piece, on
+// the thread that owns the engine.
+//
+// Customers are kept in a trigram index over id, name, email, phone and
+// company. A running query holds its own reference to the index. Changes
+// that arrive meanwhile are queued, newest per customer, and applied once the
+// last query lets go, so neither side locks and the index is never copied.
+// Exact queries skip the worker and are answered from a hash of the field
+// values, which is updated at once.
+class CustomerSearchEngine : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DebounceMsecs = 200;
+    static constexpr int FuzzyLimit = 50; // fuzzy results kept
+
+    explicit CustomerSearchEngine(QObject *parent = nullptr);
+    ~CustomerSearchEngine() override;
+
+    // Rebuilds the index. This and the incremental updates below rerun the
+    // current query after the debounce delay, so a bulk change costs one rerun.
+    void setCustomers(const std::vector<Customer>& customers);
+    // Adds the customer, or replaces the one with the same id
+    void insertCustomer(const Customer& customer);
+    void removeCustomer(const QString& customerId);
+
+    // Starts the query once typing pauses for DebounceMsecs
+    void search(const QString& text, CustomerSearchMode mode);
+    // Starts the query right away
+    void searchNow(const QString& text, CustomerSearchMode mode);
+    void cancel();
+
+signals:
+    void matchesReady(const CustomerMatches& matches);
+
+private:
+    static QString searchTextOf(const Customer& customer);
+    QString currentText(const QString& customerId) const;
+    void applyPendingChanges();
+    void addExactKeys(const QString& customerId, const QString& text);
+    void removeExactKeys(const QString& customerId, const QString& text);
+    void indexChanged();
+    void start();
+
+    QTimer m_debounce;
+    QThreadPool m_pool; // one thread; a superseded query bails out early
+    std::shared_ptr<TrigramIndex> m_index;
+    QHash<QString, QString> m_pending; // customer id -> new text, null to remove
+    QHash<QString, QSet<QString>> m_exactIndex; // lowercased field -> customer ids
+
+    QString m_text;
+    CustomerSearchMode m_mode = CustomerSearchMode::Substring;
+    quint64 m_generation = 0; // bumped per query, stale results are dropped
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+#endif // CUSTOMERSEARCHENGINE_H
@@ -1,28 +1,92 @@
 #include "order.h"
-#include <QUuid>
+#include "productcatalog.h"
+#include <cstring>
+#include <atomic>
+
+namespace {
+
+constexpr qint64 IdEpoch = 1577836800000; // 2020-01-01T00:00:00Z in msecs
+constexpr int SequenceBits = 22;          // ids per millisecond before borrowing from the next one
+constexpr int IdDigits = 13;              // 13 * 5 bits cover 64
+const char IdPrefix[] = "ORD-";
+const int IdPrefixSize = 4;
+
+// Crockford base32; the digits are in ascending ASCII order, so the
+// fixed-width strings compare the same way as the values
+const char IdAlphabet[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+std::atomic<quint64> lastId{0};
+
+int idDigitValue(QChar c) {
+    const char* digit = c.unicode() < 128 ? std::strchr(IdAlphabet, c.toLatin1()) : nullptr;
+    return digit && *digit ? int(digit - IdAlphabet) : -1;
+}
+
+// Never hands out a value twice and never goes backwards, even if the clock does
+quint64 nextId() {
+    const quint64 now = quint64(QDateTime::currentMSecsSinceEpoch() - IdEpoch) << SequenceBits;
+    quint64 last = lastId.load(std::memory_order_relaxed);
+    quint64 next;
+    do {
+        next = qMax(now, last + 1);
+    } while (!lastId.compare_exchange_weak(last, next, std::memory_order_relaxed));
+    return next;
+}
+
+// Keeps ids generated after a restore above the restored ones
+void observeId(quint64 value) {
+    quint64 last = lastId.load(std::memory_order_relaxed);
+    while (last < value && !lastId.compare_exchange_weak(last, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+OrderItem::OrderItem(const QString& productName, int quantity, double price)
+    : productId(ProductCatalog::instance().intern(productName)), quantity(quantity), price(price)
+{
+}
+
+QString OrderItem::productName() const {
+    return ProductCatalog::instance().name(productId);
+}
 
 Order::Order()
-    : m_id(generateId()), m_orderDate(QDateTime::currentDateTime()), m_status(Pending)
+    : m_status(Pending)
 {
+    assignNewId();
 }
 
 Order::Order(const QString& customerId)
-    : m_id(generateId()), m_customerId(customerId), m_orderDate(QDateTime::currentDateTime()), m_status(Pending)
+    : m_customerId(customerId), m_status(Pending)
 {
+    assignNewId();
 }
 
-void Order::removeItem(int index) {
-    if (index >= 0 && index < m_items.size()) {
-        m_items.removeAt(index);
+Order::Order(const QString& id, const QString& customerId, const QDateTime& orderDate)
+    : m_id(id), m_customerId(customerId), m_orderDate(orderDate), m_status(Pending)
+{
+    quint64 value = 0;
+    if (parseId(id, &value)) {
+        observeId(value);
     }
 }
 
-double Order::total() const {
-    double sum = 0.0;
-    for (const auto& item : m_items) {
-        sum += item.total();
+void Order::addItem(const OrderItem& item) {
+    m_items.append(item);
+    m_total += item.total();
+}
+
+void Order::removeItem(int index) {
+    if (index >= 0 && index < m_items.size()) {
+        m_items.remove(index);
+
+        // Re-sum rather than subtract so the cached total cannot drift
+        m_total = 0.0;
+        for (const auto& item : m_items) {
+            m_total += item.total();
+        }
     }
-    return sum;
 }
 
 QString Order::statusToString(Status status) {
@@ -45,6 +109,41 @@ Order::Status Order::stringToStatus(const QString& str) {
     return Pending;
 }
 
-QString Order::generateId() {
-    return QString("ORD-%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces).left(8).toUpper());
+void Order::assignNewId() {
+    // The date comes from the clock, not the id: restored ids raise the id
+    // counter, and one with a future timestamp must not date new orders
+    m_id = formatId(nextId());
+    m_orderDate = QDateTime::currentDateTime();
+}
+
+QString Order::formatId(quint64 value) {
+    QString id(IdPrefixSize + IdDigits, Qt::Uninitialized);
+    QChar* out = id.data();
+    for (int i = 0; i < IdPrefixSize; ++i) {
+        out[i] = QLatin1Char(IdPrefix[i]);
+    }
+    for (int i = IdPrefixSize + IdDigits - 1; i >= IdPrefixSize; --i) {
+        out[i] = QLatin1Char(IdAlphabet[value & 31]);
+        value >>= 5;
+    }
+    return id;
+}
+
+bool Order::parseId(const QString& id, quint64* value) {
+    // Ids from before this format (ORD- plus 8 hex digits) do not parse
+    if (id.size() != IdPrefixSize + IdDigits || !id.startsWith(QLatin1String(IdPrefix))) {
+        return false;
+    }
+
+    // 13 digits hold 65 bits, so the leading one must fit in the top four
+    if (idDigitValue(id[IdPrefixSize]) > 15) return false;
+
+    quint64 result = 0;
+    for (int i = IdPrefixSize; i < id.size(); ++i) {
+        const int digit = idDigitValue(id[i]);
+        if (digit < 0) return false;
+        result = (result << 5) | quint64(digit);
+    }
+    *value = result;
+    return true;
 }
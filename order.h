@@ -4,18 +4,31 @@
 #include <QString>
 #include <QDateTime>
 #include <QList>
+#include <QVarLengthArray>
 
+// Product names are interned in ProductCatalog; items only carry the id
 struct OrderItem {
-    QString productName;
+    int productId;
     int quantity;
     double price;
 
+    OrderItem() : productId(-1), quantity(0), price(0) {}
+    OrderItem(const QString& productName, int quantity, double price);
+
+    QString productName() const;
     double total() const { return quantity * price; }
 };
+Q_DECLARE_TYPEINFO(OrderItem, Q_RELOCATABLE_TYPE);
 
-class Order : public QObject{
-    Q_OBJECT
+// Plain value type: copyable and movable, no QObject overhead. OrderManager
+// hands orders out as QSharedPointer<Order>, which stays a stable handle
+// because the order itself never moves once it is stored.
+class Order {
 public:
+    // Most orders have a handful of items; those live inside the Order
+    // itself instead of in a separate heap block
+    using ItemList = QVarLengthArray<OrderItem, 4>;
+
     enum Status {
         Pending,
         Processing,
@@ -23,35 +36,48 @@ public:
         Delivered,
         Cancelled
     };
+    static constexpr int StatusCount = Cancelled + 1;
 
     Order();
     Order(const QString& customerId);
+    // Restores a persisted order with its original identity
+    Order(const QString& id, const QString& customerId, const QDateTime& orderDate);
 
     QString id() const { return m_id; }
     QString customerId() const { return m_customerId; }
     QString customerName() const { return m_customerName; }
     QDateTime orderDate() const { return m_orderDate; }
     Status status() const { return m_status; }
-    QList<OrderItem> items() const { return m_items; }
+    const ItemList& items() const { return m_items; }
+    int itemCount() const { return static_cast<int>(m_items.size()); }
 
     void setCustomerName(const QString& name) { m_customerName = name; }
     void setStatus(Status status) { m_status = status; }
-    void addItem(const OrderItem& item) { m_items.append(item); }
+    void addItem(const OrderItem& item);
+    void reserveItems(int count) { m_items.reserve(count); }
     void removeItem(int index);
-    double total() const;
+    double total() const { return m_total; }
 
     static QString statusToString(Status status);
     static Status stringToStatus(const QString& str);
 
+    // New ids are "ORD-" plus 13 Crockford base32 digits of a 64-bit value:
+    // creation time in milliseconds in the high bits, a sequence number in
+    // the low bits. They are unique within the process and never go backwards,
+    // but only identify an order; its date comes from the clock.
+    static QString formatId(quint64 value);
+    static bool parseId(const QString& id, quint64* value);
+
 private:
     QString m_id;
     QString m_customerId;
     QString m_customerName;
     QDateTime m_orderDate;
     Status m_status;
-    QList<OrderItem> m_items;
+    ItemList m_items;
+    double m_total = 0; // kept in step with m_items by addItem/removeItem
 
-    QString generateId();
+    void assignNewId();
 };
 
 #endif // ORDER_H
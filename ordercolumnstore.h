@@ -0,0 +1,39 @@
+#ifndef ORDERCOLUMNSTORE_H
+#define ORDERCOLUMNSTORE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "order.h"
+
+// Struct-of-arrays mirror of OrderManager::m_orders. Row i describes the
+// order at position i, so scans run over contiguous memory instead of
+// chasing QSharedPointer<Order> across the heap.
+class OrderColumnStore {
+public:
+    void reserve(int count);
+    void clear();
+    int size() const { return static_cast<int>(m_totals.size()); }
+
+    void append(const Order& order);
+    void removeAt(int row); // swap-remove, same as OrderStore::remove
+    void setStatus(int row, Order::Status status);
+
+    int customerOrdinal(const QString& customerId) const { return m_customerOrdinals.value(customerId, -1); }
+
+    // Scan kernels
+    double revenueInRange(qint64 from, qint64 to) const;
+    int countByStatus(Order::Status status) const;
+
+private:
+    std::vector<qint64> m_dates;      // msecs since epoch
+    std::vector<quint8> m_statuses;
+    std::vector<int> m_customers;     // ordinal into m_customerIds
+    std::vector<double> m_totals;
+
+    QHash<QString, int> m_customerOrdinals;
+    QStringList m_customerIds;
+};
+
+#endif // ORDERCOLUMNSTORE_H
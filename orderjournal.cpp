@@ -0,0 +1,199 @@
+#include "orderjournal.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QtEndian>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int FrameHeaderSize = 6; // quint32 length + quint16 checksum
+
+QDataStream& prepare(QDataStream& stream) {
+    stream.setVersion(QDataStream::Qt_6_0);
+    return stream;
+}
+
+} // namespace
+
+OrderJournal::OrderJournal(const QString& path)
+    : m_file(path)
+{
+}
+
+bool OrderJournal::open() {
+    return m_file.open(QIODevice::ReadWrite);
+}
+
+bool OrderJournal::replay(quint64 generation, const std::function<void(const Record&)>& apply) {
+    if (!m_file.seek(0)) return false;
+
+    qint64 good = 0;
+    m_recordCount = 0;
+    while (true) {
+        char header[FrameHeaderSize];
+        if (m_file.read(header, FrameHeaderSize) != FrameHeaderSize) break;
+
+        const quint32 length = qFromLittleEndian<quint32>(header);
+        const quint16 checksum = qFromLittleEndian<quint16>(header + 4);
+        if (length > MaxRecordSize) break;
+
+        const QByteArray payload = m_file.read(length);
+        if (payload.size() != qsizetype(length) || qChecksum(payload) != checksum) break;
+
+        Record record;
+        if (!decode(payload, record)) break;
+
+        if (good == 0) {
+            const quint64 written = record.type == GenerationRecord ? record.generation : 0;
+            if (written != generation) {
+                qWarning() << "Discarding order journal" << m_file.fileName()
+                           << "written for snapshot generation" << written << "instead of" << generation;
+                return reset(generation);
+            }
+            if (record.type == GenerationRecord) {
+                good = m_file.pos();
+                continue;
+            }
+        }
+        if (record.type == GenerationRecord) break;
+
+        apply(record);
+        good = m_file.pos();
+        ++m_recordCount;
+    }
+
+    // Nothing usable, so start over with the stamp later replays check
+    if (good == 0) {
+        return reset(generation);
+    }
+
+    if (good < m_file.size()) {
+        qWarning() << "Discarding" << m_file.size() - good << "bytes of incomplete journal records in" << m_file.fileName();
+        if (!m_file.resize(good)) return false;
+    }
+    return m_file.seek(good);
+}
+
+bool OrderJournal::appendAdd(const Order& order) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    prepare(out) << quint8(AddRecord) << order.id() << order.customerId() << order.customerName()
+                 << qint64(order.orderDate().toMSecsSinceEpoch()) << quint8(order.status())
+                 << quint32(order.itemCount());
+    for (const auto& item : order.items()) {
+        out << item.productName() << qint32(item.quantity) << item.price;
+    }
+    return append(payload);
+}
+
+bool OrderJournal::appendStatus(const QString& id, Order::Status status) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    prepare(out) << quint8(StatusRecord) << id << quint8(status);
+    return append(payload);
+}
+
+bool OrderJournal::appendDelete(const QString& id) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    prepare(out) << quint8(DeleteRecord) << id;
+    return append(payload);
+}
+
+bool OrderJournal::append(const QByteArray& payload) {
+    char header[FrameHeaderSize];
+    qToLittleEndian<quint32>(quint32(payload.size()), header);
+    qToLittleEndian<quint16>(qChecksum(payload), header + 4);
+
+    // Synced per record so a crash or power loss loses at most the record being written
+    const bool ok = m_file.write(header, FrameHeaderSize) == FrameHeaderSize
+                    && m_file.write(payload) == payload.size()
+                    && (!m_autoFlush || sync());
+    if (!ok) {
+        qWarning() << "Failed to append to order journal:" << m_file.errorString();
+        return false;
+    }
+    ++m_recordCount;
+    return true;
+}
+
+bool OrderJournal::flush() {
+    if (!sync()) {
+        qWarning() << "Failed to flush order journal:" << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// QFile::flush() only hands the data to the OS; this also waits for the disk
+bool OrderJournal::sync() {
+    if (!m_file.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(m_file.handle()) == 0;
+#else
+    return ::fsync(m_file.handle()) == 0;
+#endif
+}
+
+bool OrderJournal::reset(quint64 generation) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    prepare(out) << quint8(GenerationRecord) << generation;
+
+    const bool ok = m_file.resize(0) && m_file.seek(0) && append(payload) && sync();
+    m_recordCount = 0;
+    return ok;
+}
+
+bool OrderJournal::decode(const QByteArray& payload, Record& record) {
+    QDataStream in(payload);
+    prepare(in);
+
+    quint8 type = 0;
+    in >> type;
+    switch (type) {
+    case AddRecord: {
+        QString id, customerId, customerName;
+        qint64 orderDate = 0;
+        quint8 status = 0;
+        quint32 itemCount = 0;
+        in >> id >> customerId >> customerName >> orderDate >> status >> itemCount;
+        if (in.status() != QDataStream::Ok || status >= Order::StatusCount) return false;
+
+        record.order = QSharedPointer<Order>::create(id, customerId, QDateTime::fromMSecsSinceEpoch(orderDate));
+        record.order->setCustomerName(customerName);
+        record.order->setStatus(Order::Status(status));
+        for (quint32 i = 0; i < itemCount && in.status() == QDataStream::Ok; ++i) {
+            QString productName;
+            qint32 quantity = 0;
+            double price = 0;
+            in >> productName >> quantity >> price;
+            record.order->addItem({productName, quantity, price});
+        }
+        break;
+    }
+    case StatusRecord: {
+        quint8 status = 0;
+        in >> record.id >> status;
+        if (status >= Order::StatusCount) return false;
+        record.status = Order::Status(status);
+        break;
+    }
+    case DeleteRecord:
+        in >> record.id;
+        break;
+    case GenerationRecord:
+        in >> record.generation;
+        break;
+    default:
+        return false;
+    }
+
+    record.type = RecordType(type);
+    return in.status() == QDataStream::Ok;
+}
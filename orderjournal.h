@@ -0,0 +1,74 @@
+#ifndef ORDERJOURNAL_H
+#define ORDERJOURNAL_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QSharedPointer>
+#include <QString>
+#include <functional>
+#include "order.h"
+
+// Append-only log of OrderManager mutations. Each record is framed as
+// [quint32 length][quint16 CRC][payload]; a record torn by a crash fails
+// its length or checksum test on replay and is cut off together with
+// everything after it. A flush also syncs the file to disk, so a record
+// survives a power loss once its append (or the batch's flush) returns.
+//
+// reset() starts the journal with the generation of the snapshot its records
+// apply to. Replay discards a journal stamped with any other generation,
+// which is what a crash between writing a new snapshot and resetting the
+// journal leaves behind.
+class OrderJournal {
+public:
+    enum RecordType : quint8 {
+        AddRecord = 1,
+        StatusRecord = 2,
+        DeleteRecord = 3,
+        GenerationRecord = 4 // first record only, never passed to replay callbacks
+    };
+
+    struct Record {
+        RecordType type = AddRecord;
+        QSharedPointer<Order> order; // AddRecord
+        QString id;                  // StatusRecord, DeleteRecord
+        Order::Status status = Order::Pending;
+        quint64 generation = 0;      // GenerationRecord
+    };
+
+    explicit OrderJournal(const QString& path);
+
+    bool open();
+    QString errorString() const { return m_file.errorString(); }
+    qint64 recordCount() const { return m_recordCount; }
+
+    // Applies every intact record in order and leaves the file positioned for
+    // appends. A journal for another snapshot generation is emptied instead;
+    // one from before generations counts as generation 0.
+    bool replay(quint64 generation, const std::function<void(const Record&)>& apply);
+
+    bool appendAdd(const Order& order);
+    bool appendStatus(const QString& id, Order::Status status);
+    bool appendDelete(const QString& id);
+
+    // Records are flushed and synced one by one unless auto-flush is off, in
+    // which case the caller flushes once after a group of appends
+    void setAutoFlush(bool enabled) { m_autoFlush = enabled; }
+    bool flush();
+
+    // Empties the journal once its contents are covered by the snapshot of
+    // the given generation, and stamps it with that generation
+    bool reset(quint64 generation);
+
+private:
+    bool append(const QByteArray& payload);
+    bool sync();
+    static bool decode(const QByteArray& payload, Record& record);
+
+    static constexpr quint32 MaxRecordSize = 16 * 1024 * 1024;
+
+    QFile m_file;
+    qint64 m_recordCount = 0;
+    bool m_autoFlush = true;
+};
+
+#endif // ORDERJOURNAL_H
@@ -0,0 +1,116 @@
+#include "orderjsonstream.h"
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+OrderJsonWriter::OrderJsonWriter(QIODevice* device)
+    : m_device(device)
+{
+}
+
+bool OrderJsonWriter::begin() {
+    m_ok = m_ok && m_device->write("[\n") >= 0;
+    return m_ok;
+}
+
+bool OrderJsonWriter::write(const QJsonObject& object) {
+    if (m_count++ > 0) {
+        m_ok = m_ok && m_device->write(",\n") >= 0;
+    }
+    m_ok = m_ok && m_device->write(QJsonDocument(object).toJson(QJsonDocument::Compact)) >= 0;
+    return m_ok;
+}
+
+bool OrderJsonWriter::finish() {
+    m_ok = m_ok && m_device->write("\n]\n") >= 0;
+    return m_ok;
+}
+
+OrderJsonReader::OrderJsonReader(QIODevice* device)
+    : m_device(device)
+{
+}
+
+bool OrderJsonReader::fail(const QString& error) {
+    m_error = error;
+    return false;
+}
+
+bool OrderJsonReader::readNext(QJsonObject& object) {
+    if (m_finished || hasError()) return false;
+
+    while (true) {
+        while (m_pos < m_buffer.size()) {
+            const char c = m_buffer.at(m_pos++);
+
+            if (m_inString) {
+                if (m_escape) {
+                    m_escape = false;
+                } else if (c == '\\') {
+                    m_escape = true;
+                } else if (c == '"') {
+                    m_inString = false;
+                }
+                continue;
+            }
+
+            switch (c) {
+            case '"':
+                m_inString = true;
+                break;
+            case '[':
+            case '{':
+                if (m_depth == 0 && c != '[') {
+                    return fail(QStringLiteral("expected a JSON array"));
+                }
+                if (m_depth == 1 && c == '{') {
+                    m_objectStart = m_pos - 1;
+                }
+                ++m_depth;
+                break;
+            case ']':
+            case '}':
+                if (m_depth == 0) {
+                    return fail(QStringLiteral("unbalanced '%1'").arg(QLatin1Char(c)));
+                }
+                if (--m_depth == 0) {
+                    m_finished = true;
+                    return false;
+                }
+                if (m_depth == 1 && m_objectStart >= 0) {
+                    QJsonParseError error;
+                    const QJsonDocument doc = QJsonDocument::fromJson(
+                        m_buffer.mid(m_objectStart, m_pos - m_objectStart), &error);
+                    m_objectStart = -1;
+                    if (error.error != QJsonParseError::NoError) {
+                        return fail(error.errorString());
+                    }
+                    object = doc.object();
+                    return true;
+                }
+                break;
+            default:
+                // Scalars between elements are skipped, like non-object array values
+                if (m_depth == 0 && !QChar::isSpace(uchar(c))) {
+                    return fail(QStringLiteral("expected a JSON array"));
+                }
+                break;
+            }
+        }
+
+        // Drop everything already scanned except a partially read element
+        const qsizetype keep = m_objectStart >= 0 ? m_objectStart : m_pos;
+        m_buffer.remove(0, keep);
+        m_pos -= keep;
+        if (m_objectStart >= 0) {
+            m_objectStart = 0;
+        }
+
+        const QByteArray chunk = m_device->read(ChunkSize);
+        if (chunk.isEmpty()) {
+            return fail(m_depth == 0 ? QStringLiteral("empty document")
+                                     : QStringLiteral("unexpected end of document"));
+        }
+        m_bytesRead += chunk.size();
+        m_buffer.append(chunk);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef ORDERJSONSTREAM_H
+#define ORDERJSONSTREAM_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QString>
+
+// Writes a JSON array one element at a time, so only the current element
+// is ever held as a QJsonObject.
+class OrderJsonWriter {
+public:
+    explicit OrderJsonWriter(QIODevice* device);
+
+    bool begin();
+    bool write(const QJsonObject& object);
+    bool finish();
+
+private:
+    QIODevice* m_device;
+    qint64 m_count = 0;
+    bool m_ok = true;
+};
+
+// Reads the objects of a top-level JSON array one at a time. Memory use is
+// bounded by the read chunk plus the largest single element.
+class OrderJsonReader {
+public:
+    explicit OrderJsonReader(QIODevice* device);
+
+    // Returns false at the end of the array or on error; check hasError()
+    bool readNext(QJsonObject& object);
+
+    bool hasError() const { return !m_error.isEmpty(); }
+    QString errorString() const { return m_error; }
+    qint64 bytesRead() const { return m_bytesRead; }
+
+private:
+    bool fail(const QString& error);
+
+    static constexpr qint64 ChunkSize = 64 * 1024;
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    qsizetype m_pos = 0;          // next byte to scan in m_buffer
+    qsizetype m_objectStart = -1; // start of the element being scanned
+    qint64 m_bytesRead = 0;
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escape = false;
+    bool m_finished = false;
+    QString m_error;
+};
+
+#endif // ORDERJSONSTREAM_H
@@ -1,17 +1,75 @@
 #include "ordermanager.h"
-#include <algorithm>
+#include "orderjsonstream.h"
+#include "ordersnapshot.h"
+#include "orderjournal.h"
+#include <atomic>
+#include <utility>
+#include <QDir>
 #include <QFile>
-#include <QJsonDocument>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
 
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cstdio>
+#endif
+
+// State shared between OrderManager and its persistence worker. The worker
+// only touches it until it finishes; the GUI thread reads the results after.
+struct OrderManager::PersistenceTask {
+    std::atomic_bool cancelled{false};
+    bool loading = false;                // a load, which rewrites the snapshot
+    bool checkConsistency = false;       // see setConsistencyChecks
+    bool ok = false;
+    QString error;
+
+    OrderStore store;                    // load: the fully indexed result
+    QList<QSharedPointer<Order>> orders; // save: the orders when it started,
+    QList<Order::Status> statuses;       // and their statuses at that time
+
+    QString snapshotPath;                // load: journal snapshot to refresh,
+    QString stagedSnapshotPath;          // where the worker writes it,
+    quint64 snapshotGeneration = 0;      // and the generation it gets
+    bool snapshotWritten = false;
+};
+
+namespace {
+
+bool setError(QString* error, const QString& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// Moves from over to in one step, so a crash leaves one of the two files whole
+bool replaceFile(const QString& from, const QString& to) {
+#ifdef Q_OS_WIN
+    return MoveFileExW(reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(from).utf16()),
+                       reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(to).utf16()),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    return ::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+}
+
+} // namespace
+
 OrderManager::OrderManager(QObject *parent) : QObject(parent) {
     loadSampleOrders();
 }
 
 OrderManager::~OrderManager() {
-    // Nothing to manually delete because we use QSharedPointer
+    // The worker refers back to this manager, so it has to stop first
+    if (m_worker) {
+        m_task->cancelled = true;
+        m_worker->wait();
+        delete m_worker;
+    }
 }
 
 void OrderManager::loadSampleOrders() {
@@ -52,231 +110,588 @@ void OrderManager::loadSampleOrders() {
     addOrder(order5);
 }
 
-void OrderManager::addOrder(QSharedPointer<Order> order) {
-    m_orders.append(order);
-    emit orderAdded(order);
+OrderManager::Batch::Batch(OrderManager* manager) : m_manager(manager) {
+    m_manager->beginBatch();
+}
+
+OrderManager::Batch::~Batch() {
+    m_manager->endBatch();
+}
+
+void OrderManager::beginBatch() {
+    if (m_batchDepth++ == 0 && m_journal) {
+        m_journal->setAutoFlush(false);
+    }
+}
+
+void OrderManager::endBatch() {
+    if (--m_batchDepth > 0) return;
+
+    if (m_journal) {
+        m_journal->flush();
+        m_journal->setAutoFlush(true);
+    }
+
+    PendingChanges pending = std::exchange(m_pending, PendingChanges());
+    if (!pending.changed) return;
+
+    // Row numbers recorded before a removal may have moved with it
+    if (pending.removedRow >= 0 && (pending.insertedFrom >= 0 || pending.updatedFirst >= 0)) {
+        pending.reset = true;
+    }
+
+    // Verified and compacted once per batch rather than once per order
+    if (m_consistencyChecks) {
+        m_store.checkConsistency();
+    }
+    if (m_journal) {
+        compactJournalIfNeeded();
+    }
+
+    if (pending.reset) {
+        emit ordersReset();
+    } else if (pending.removedRow >= 0) {
+        emit orderRemoved(pending.removedRow, pending.movedFrom);
+    } else {
+        if (pending.insertedFrom >= 0) {
+            emit ordersInserted(pending.insertedFrom, m_store.size() - 1);
+        }
+        if (pending.updatedFirst >= 0) {
+            emit ordersUpdated(pending.updatedFirst, pending.updatedLast);
+        }
+    }
     emit dataChanged();
 }
 
+bool OrderManager::insertOrder(const QSharedPointer<Order>& order) {
+    if (!m_store.insert(order)) return false;
+
+    if (m_journal) {
+        m_journal->appendAdd(*order);
+    }
+    if (m_pending.insertedFrom < 0) {
+        m_pending.insertedFrom = m_store.size() - 1;
+    }
+    m_pending.changed = true;
+    return true;
+}
+
+QSharedPointer<Order> OrderManager::setOrderStatus(const QString& id, Order::Status status) {
+    QSharedPointer<Order> order = m_store.setStatus(id, status);
+    if (!order) return order;
+
+    if (m_journal) {
+        m_journal->appendStatus(id, status);
+    }
+    const int row = m_store.indexOf(id);
+    m_pending.updatedFirst = m_pending.updatedFirst < 0 ? row : qMin(m_pending.updatedFirst, row);
+    m_pending.updatedLast = qMax(m_pending.updatedLast, row);
+    m_pending.changed = true;
+    return order;
+}
+
+void OrderManager::addOrder(QSharedPointer<Order> order) {
+    // The per-order signal only goes out when this is not part of a larger batch
+    const bool batched = m_batchDepth > 0;
+    Batch batch(this);
+    if (insertOrder(order) && !batched) {
+        emit orderAdded(order);
+    }
+}
+
 void OrderManager::updateOrderStatus(const QString& id, Order::Status status) {
-    int index = findOrderIndex(id);
-    if (index >= 0) {
-        m_orders[index]->setStatus(status);
-        emit orderUpdated(m_orders[index]);
-        emit dataChanged();
+    const bool batched = m_batchDepth > 0;
+    Batch batch(this);
+    QSharedPointer<Order> order = setOrderStatus(id, status);
+    if (order && !batched) {
+        emit orderUpdated(order);
     }
 }
 
 void OrderManager::deleteOrder(const QString& id) {
-    int index = findOrderIndex(id);
-    if (index >= 0) {
-        m_orders.removeAt(index);
-        emit orderDeleted(id);
-        emit dataChanged();
+    const bool batched = m_batchDepth > 0;
+    Batch batch(this);
+    const int row = m_store.indexOf(id);
+    const int last = m_store.size() - 1;
+    if (m_store.remove(id)) {
+        if (m_journal) {
+            m_journal->appendDelete(id);
+        }
+
+        // Only one removal per batch can be described by row numbers
+        if (m_pending.removedRow >= 0) {
+            m_pending.reset = true;
+        }
+        m_pending.removedRow = row;
+        m_pending.movedFrom = last;
+        m_pending.changed = true;
+        if (!batched) {
+            emit orderDeleted(id);
+        }
     }
 }
 
-int OrderManager::findOrderIndex(const QString& id) const {
-    for (int i = 0; i < m_orders.size(); ++i) {
-        if (m_orders[i]->id() == id) {
-            return i;
-        }
+void OrderManager::addOrders(const QList<QSharedPointer<Order>>& orders) {
+    Batch batch(this);
+    m_store.reserve(m_store.size() + orders.size());
+    for (const auto& order : orders) {
+        insertOrder(order);
+    }
+}
+
+void OrderManager::updateStatuses(const QStringList& ids, Order::Status status) {
+    Batch batch(this);
+    for (const QString& id : ids) {
+        setOrderStatus(id, status);
     }
-    return -1;
 }
 
 QList<QSharedPointer<Order>> OrderManager::getAllOrders() const {
-    return m_orders;
+    return m_store.orders();
 }
 
 QList<QSharedPointer<Order>> OrderManager::getOrdersByCustomer(const QString& customerId) const {
-    QList<QSharedPointer<Order>> results;
-    for (const auto& order : m_orders) {
-        if (order->customerId() == customerId) {
-            results.append(order);
-        }
-    }
-    return results;
+    return m_store.byCustomer(customerId);
 }
 
 QList<QSharedPointer<Order>> OrderManager::getOrdersByStatus(Order::Status status) const {
-    QList<QSharedPointer<Order>> results;
-    for (const auto& order : m_orders) {
-        if (order->status() == status) {
-            results.append(order);
-        }
-    }
-    return results;
+    return m_store.byStatus(status);
 }
 
 QList<QSharedPointer<Order>> OrderManager::getOrdersByDateRange(const QDateTime& from, const QDateTime& to) const {
-    QList<QSharedPointer<Order>> results;
-    for (const auto& order : m_orders) {
-        if (order->orderDate() >= from && order->orderDate() <= to) {
-            results.append(order);
-        }
-    }
-    return results;
+    return m_store.byDateRange(from, to);
 }
 
 QSharedPointer<Order> OrderManager::getOrder(const QString& id) {
-    int index = findOrderIndex(id);
-    return (index >= 0) ? m_orders[index] : nullptr;
+    return m_store.order(id);
+}
+
+QSharedPointer<Order> OrderManager::orderAt(int row) const {
+    return (row >= 0 && row < m_store.size()) ? m_store.orders().at(row) : nullptr;
 }
 
 QList<QSharedPointer<Order>> OrderManager::searchOrders(const QString& searchText) const {
-    QList<QSharedPointer<Order>> results;
-    QString lowerSearch = searchText.toLower();
-
-    for (const auto& order : m_orders) {
-        if (order->id().toLower().contains(lowerSearch) ||
-            order->customerName().toLower().contains(lowerSearch)) {
-            results.append(order);
-            continue;
-        }
+    return m_store.search(searchText);
+}
 
-        bool found = false;
-        for (const auto& item : order->items()) {
-            if (item.productName.toLower().contains(lowerSearch)) {
-                results.append(order);
-                found = true;
-                break;
-            }
-        }
+OrderPage OrderManager::getOrdersPage(const QString& token, int limit) const {
+    return m_store.page(token, limit);
+}
 
-        if (!found && Order::statusToString(order->status()).toLower().contains(lowerSearch)) {
-            results.append(order);
-        }
-    }
+OrderPage OrderManager::getOrdersByCustomerPage(const QString& customerId, const QString& token, int limit) const {
+    return m_store.customerPage(customerId, token, limit);
+}
 
-    return results;
+OrderPage OrderManager::getOrdersByStatusPage(Order::Status status, const QString& token, int limit) const {
+    return m_store.statusPage(status, token, limit);
+}
+
+OrderPage OrderManager::searchOrdersPage(const QString& searchText, const QString& token, int limit) const {
+    return m_store.searchPage(searchText, token, limit);
+}
+
+QList<QSharedPointer<Order>> OrderManager::runQuery(const OrderQuery& query) const {
+    return m_store.select(query);
+}
+
+QString OrderManager::explainQuery(const OrderQuery& query) const {
+    return m_store.explain(query);
 }
 
 double OrderManager::getTotalRevenue() const {
-    double total = 0;
-    for (const auto& order : m_orders) {
-        total += order->total();
-    }
-    return total;
+    return m_store.totalRevenue();
 }
 
 double OrderManager::getRevenueByCustomer(const QString& customerId) const {
-    double total = 0;
-    for (const auto& order : m_orders) {
-        if (order->customerId() == customerId) {
-            total += order->total();
-        }
-    }
-    return total;
+    return m_store.revenueByCustomer(customerId);
 }
 
 double OrderManager::getRevenueByDateRange(const QDateTime& from, const QDateTime& to) const {
-    double total = 0;
-    for (const auto& order : m_orders) {
-        if (order->orderDate() >= from && order->orderDate() <= to) {
-            total += order->total();
-        }
-    }
-    return total;
+    return m_store.revenueByDateRange(from, to);
 }
 
 int OrderManager::getTotalOrderCount() const {
-    return m_orders.size();
+    return m_store.size();
 }
 
 int OrderManager::getOrderCountByStatus(Order::Status status) const {
-    int count = 0;
-    for (const auto& order : m_orders) {
-        if (order->status() == status) {
-            count++;
-        }
-    }
-    return count;
+    return m_store.countByStatus(status);
 }
 
 double OrderManager::getAverageOrderValue() const {
-    if (m_orders.isEmpty()) return 0;
-    return getTotalRevenue() / m_orders.size();
+    if (m_store.size() == 0) return 0;
+    return getTotalRevenue() / m_store.size();
+}
+
+QList<OrderRollup::Bucket> OrderManager::getRevenueRollup(OrderRollup::Period period,
+                                                          const QDate& from, const QDate& to) const {
+    return m_store.rollup(period, from, to);
+}
+
+QJsonObject OrderManager::orderToJson(const Order& order, Order::Status status) {
+    QJsonObject orderObj;
+    orderObj["id"] = order.id();
+    orderObj["customerId"] = order.customerId();
+    orderObj["customerName"] = order.customerName();
+    orderObj["orderDate"] = order.orderDate().toString(Qt::ISODateWithMs);
+    orderObj["status"] = Order::statusToString(status);
+
+    QJsonArray itemsArray;
+    for (const auto& item : order.items()) {
+        QJsonObject itemObj;
+        itemObj["productName"] = item.productName();
+        itemObj["quantity"] = item.quantity;
+        itemObj["price"] = item.price;
+        itemsArray.append(itemObj);
+    }
+    orderObj["items"] = itemsArray;
+    return orderObj;
 }
 
-bool OrderManager::saveToFile(const QString& filename) const {
+QString OrderManager::intern(QSet<QString>& strings, const QString& text) {
+    auto it = strings.constFind(text);
+    if (it != strings.constEnd()) return *it;
+    strings.insert(text);
+    return text;
+}
+
+QSharedPointer<Order> OrderManager::orderFromJson(const QJsonObject& orderObj, QSet<QString>& strings) {
+    // Repeated customer ids and names share one QString across the whole file
+    const QString customerId = intern(strings, orderObj["customerId"].toString());
+
+    // Keep the stored identity; fall back to a fresh one if the file lacks it
+    const QString id = orderObj["id"].toString();
+    const QDateTime orderDate = QDateTime::fromString(orderObj["orderDate"].toString(), Qt::ISODate);
+    auto order = !id.isEmpty() && orderDate.isValid()
+                     ? QSharedPointer<Order>::create(id, customerId, orderDate)
+                     : QSharedPointer<Order>::create(customerId);
+    order->setCustomerName(intern(strings, orderObj["customerName"].toString()));
+    order->setStatus(Order::stringToStatus(orderObj["status"].toString()));
+
+    const QJsonArray itemsArray = orderObj["items"].toArray();
+    order->reserveItems(itemsArray.size());
+    for (const QJsonValue& itemValue : itemsArray) {
+        if (!itemValue.isObject()) continue;
+
+        const QJsonObject itemObj = itemValue.toObject();
+        order->addItem({itemObj["productName"].toString(),
+                        itemObj["quantity"].toInt(),
+                        itemObj["price"].toDouble()});
+    }
+    return order;
+}
+
+OrderManager::Progress OrderManager::progressReporter(const std::shared_ptr<PersistenceTask>& task) {
+    // Only whole-percent changes are reported. A worker posts them to the
+    // GUI thread and learns about cancellation through its return value.
+    return [this, task, lastPercentage = -1](qint64 done, qint64 total) mutable {
+        const int percentage = total > 0 ? int(done * 100 / total) : 100;
+        if (percentage != lastPercentage) {
+            lastPercentage = percentage;
+            if (task) {
+                QMetaObject::invokeMethod(this, [this, percentage]() {
+                    emit persistenceProgress(percentage);
+                }, Qt::QueuedConnection);
+            } else {
+                emit persistenceProgress(percentage);
+            }
+        }
+        return !task || !task->cancelled;
+    };
+}
+
+bool OrderManager::readOrders(const QString& filename, QList<QSharedPointer<Order>>& orders,
+                              const Progress& progress, QString* error) {
     QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Cannot open file for writing:" << filename;
-        return false;
+    if (!file.open(QIODevice::ReadOnly)) {
+        return setError(error, file.errorString());
+    }
+
+    if (OrderSnapshot::isSnapshot(&file)) {
+        return OrderSnapshot::read(file, orders, progress, error);
     }
 
-    QJsonArray ordersArray;
-    for (const auto& order : m_orders) {
-        QJsonObject orderObj;
-        orderObj["id"] = order->id();
-        orderObj["customerId"] = order->customerId();
-        orderObj["customerName"] = order->customerName();
-        orderObj["orderDate"] = order->orderDate().toString(Qt::ISODate);
-        orderObj["status"] = Order::statusToString(order->status());
-
-        QJsonArray itemsArray;
-        for (const auto& item : order->items()) {
-            QJsonObject itemObj;
-            itemObj["productName"] = item.productName;
-            itemObj["quantity"] = item.quantity;
-            itemObj["price"] = item.price;
-            itemsArray.append(itemObj);
+    // Parse into a side list first so a malformed file leaves the caller's orders untouched
+    QList<QSharedPointer<Order>> loaded;
+    QSet<QString> strings;
+    OrderJsonReader reader(&file);
+    QJsonObject orderObj;
+    while (reader.readNext(orderObj)) {
+        loaded.append(orderFromJson(orderObj, strings));
+        if (progress && !progress(reader.bytesRead(), file.size())) {
+            return setError(error, QStringLiteral("cancelled"));
         }
-        orderObj["items"] = itemsArray;
+    }
 
-        ordersArray.append(orderObj);
+    if (reader.hasError()) {
+        return setError(error, reader.errorString());
     }
+    orders = std::move(loaded);
+    return true;
+}
 
-    QJsonDocument doc(ordersArray);
-    file.write(doc.toJson());
-    file.close();
+bool OrderManager::writeOrders(const QString& filename, const QList<QSharedPointer<Order>>& orders,
+                               const QList<Order::Status>& statuses,
+                               FileFormat format, const Progress& progress, QString* error) {
+    if (format == BinaryFormat) {
+        return OrderSnapshot::write(filename, orders, statuses, 0, progress, error);
+    }
 
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return setError(error, file.errorString());
+    }
+
+    // Stream one order at a time instead of building the whole document.
+    // Returning early leaves the target untouched, QSaveFile discards the rest.
+    OrderJsonWriter writer(&file);
+    writer.begin();
+    for (int i = 0; i < orders.size(); ++i) {
+        writer.write(orderToJson(*orders[i], statuses.isEmpty() ? orders[i]->status() : statuses[i]));
+        if (progress && !progress(i + 1, orders.size())) {
+            return setError(error, QStringLiteral("cancelled"));
+        }
+    }
+
+    if (!writer.finish() || !file.commit()) {
+        return setError(error, file.errorString());
+    }
+    return true;
+}
+
+bool OrderManager::saveToFile(const QString& filename, FileFormat format) {
+    QString error;
+    if (!writeOrders(filename, m_store.orders(), {}, format, progressReporter(), &error)) {
+        qWarning() << "Failed to write orders to file:" << filename << error;
+        return false;
+    }
     return true;
 }
 
 bool OrderManager::loadFromFile(const QString& filename) {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Cannot open file for reading:" << filename;
+    QList<QSharedPointer<Order>> loaded;
+    QString error;
+    if (!readOrders(filename, loaded, progressReporter(), &error)) {
+        qWarning() << "Cannot load orders from file:" << filename << error;
         return false;
     }
 
-    QByteArray data = file.readAll();
-    file.close();
+    OrderStore store;
+    store.reserve(loaded.size());
+    for (const auto& order : std::as_const(loaded)) {
+        store.insert(order);
+    }
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isArray()) {
-        qWarning() << "Invalid JSON format in file:" << filename;
-        return false;
+    Batch batch(this);
+    std::swap(m_store, store);
+    m_pending.reset = true;
+    m_pending.changed = true;
+
+    // A full reload replaces the journalled history
+    if (m_journal) {
+        compactJournal();
     }
+    return true;
+}
 
-    m_orders.clear();
-    QJsonArray ordersArray = doc.array();
+void OrderManager::startWorker(const std::shared_ptr<PersistenceTask>& task,
+                               std::function<void()> work, std::function<void()> finished) {
+    m_task = task;
+    m_worker = QThread::create(std::move(work));
+    connect(m_worker, &QThread::finished, this, [this, finished]() {
+        m_worker->deleteLater();
+        m_worker = nullptr;
+        m_task.reset();
+        finished();
+    });
+    m_worker->start();
+}
 
-    for (const QJsonValue& value : ordersArray) {
-        if (!value.isObject()) continue;
+bool OrderManager::loadFromFileAsync(const QString& filename) {
+    if (isPersistenceRunning()) {
+        qWarning() << "Order persistence already in progress, cannot load:" << filename;
+        return false;
+    }
 
-        QJsonObject orderObj = value.toObject();
-        auto order = QSharedPointer<Order>::create(orderObj["customerId"].toString());
-        order->setCustomerName(orderObj["customerName"].toString());
-        order->setStatus(Order::stringToStatus(orderObj["status"].toString()));
+    auto task = std::make_shared<PersistenceTask>();
+    task->loading = true;
+    task->checkConsistency = m_consistencyChecks;
+    if (m_journal) {
+        // Staged next to the live snapshot, which only the GUI thread replaces
+        task->snapshotPath = m_snapshotPath;
+        task->stagedSnapshotPath = m_snapshotPath + QStringLiteral(".loading");
+        task->snapshotGeneration = m_snapshotGeneration + 1;
+    }
 
-        QJsonArray itemsArray = orderObj["items"].toArray();
-        for (const QJsonValue& itemValue : itemsArray) {
-            if (!itemValue.isObject()) continue;
+    startWorker(task, [task, filename, progress = progressReporter(task)]() {
+        QList<QSharedPointer<Order>> loaded;
+        task->ok = readOrders(filename, loaded, progress, &task->error);
+        if (!task->ok) return;
+
+        // Build every index here too, so the GUI thread only has to swap
+        task->store.reserve(loaded.size());
+        for (int i = 0; i < loaded.size(); ++i) {
+            if (i % 1024 == 0 && task->cancelled) {
+                task->ok = setError(&task->error, QStringLiteral("cancelled"));
+                return;
+            }
+            task->store.insert(loaded[i]);
+        }
+        if (task->checkConsistency) {
+            task->store.checkConsistency();
+        }
 
-            QJsonObject itemObj = itemValue.toObject();
-            OrderItem item;
-            item.productName = itemObj["productName"].toString();
-            item.quantity = itemObj["quantity"].toInt();
-            item.price = itemObj["price"].toDouble();
-            order->addItem(item);
+        // Writing the journal snapshot is O(N) as well, so do it before handing over
+        if (!task->snapshotPath.isEmpty()) {
+            task->snapshotWritten = OrderSnapshot::write(task->stagedSnapshotPath, loaded, {},
+                                                         task->snapshotGeneration, {}, nullptr);
         }
+    }, [this, task]() {
+        if (task->ok) {
+            Batch batch(this);
+            std::swap(m_store, task->store);
+            m_pending.reset = true;
+            m_pending.changed = true;
+
+            // Anything journalled while the worker ran was dropped by the swap as
+            // well. The staged snapshot's newer generation voids the old journal
+            // the moment it is published, even if resetting it never happens.
+            if (m_journal) {
+                if (task->snapshotWritten && task->snapshotPath == m_snapshotPath
+                    && task->snapshotGeneration == m_snapshotGeneration + 1
+                    && replaceFile(task->stagedSnapshotPath, m_snapshotPath)) {
+                    m_snapshotGeneration = task->snapshotGeneration;
+                    m_journal->reset(m_snapshotGeneration);
+                } else {
+                    compactJournal();
+                }
+            }
 
-        m_orders.append(order);
+            // Free the replaced orders without blocking the GUI thread
+            QThreadPool::globalInstance()->start([task]() {
+                task->store.clear();
+            });
+        }
+        if (!task->stagedSnapshotPath.isEmpty()) {
+            QFile::remove(task->stagedSnapshotPath); // left over unless it was published
+        }
+        emit loadFinished(task->ok, task->error);
+    });
+    return true;
+}
+
+bool OrderManager::saveToFileAsync(const QString& filename, FileFormat format) {
+    if (isPersistenceRunning()) {
+        qWarning() << "Order persistence already in progress, cannot save:" << filename;
+        return false;
     }
 
-    emit dataChanged();
+    // Once stored, an order only ever changes its status, so the worker shares
+    // the orders themselves and writes statuses captured here instead. That
+    // costs one pass and one enum per order rather than a copy of each order.
+    auto task = std::make_shared<PersistenceTask>();
+    task->orders = m_store.orders();
+    task->statuses.reserve(task->orders.size());
+    for (const auto& order : task->orders) {
+        task->statuses.append(order->status());
+    }
+
+    startWorker(task, [task, filename, format, progress = progressReporter(task)]() {
+        task->ok = writeOrders(filename, task->orders, task->statuses, format, progress, &task->error);
+    }, [this, task]() {
+        emit saveFinished(task->ok, task->error);
+    });
+    return true;
+}
+
+void OrderManager::cancelPersistence() {
+    if (m_task) {
+        m_task->cancelled = true;
+    }
+}
+
+bool OrderManager::isPersistenceRunning() const {
+    return m_worker != nullptr;
+}
+
+bool OrderManager::openJournal(const QString& directory) {
+    if (!QDir().mkpath(directory)) {
+        qWarning() << "Cannot create journal directory:" << directory;
+        return false;
+    }
+
+    const QDir dir(directory);
+    auto journal = std::make_unique<OrderJournal>(dir.filePath("orders.journal"));
+    if (!journal->open()) {
+        qWarning() << "Cannot open order journal:" << journal->errorString();
+        return false;
+    }
+
+    // Detach any previous journal so restoring does not log itself
+    m_journal.reset();
+    const QString snapshotPath = dir.filePath("orders.snapshot");
+    const bool hasSnapshot = QFile::exists(snapshotPath);
+    quint64 generation = 0;
+    if (hasSnapshot && (!OrderSnapshot::readGeneration(snapshotPath, &generation) || !loadFromFile(snapshotPath))) {
+        return false;
+    }
+
+    // Every snapshot gets a new generation, so a journal that a crash left
+    // behind after a compaction or a load published one is discarded here
+    bool replayed = false;
+    {
+        Batch batch(this);
+        replayed = journal->replay(generation, [this](const OrderJournal::Record& record) {
+            switch (record.type) {
+            case OrderJournal::AddRecord:
+                addOrder(record.order);
+                break;
+            case OrderJournal::StatusRecord:
+                updateOrderStatus(record.id, record.status);
+                break;
+            case OrderJournal::DeleteRecord:
+                deleteOrder(record.id);
+                break;
+            case OrderJournal::GenerationRecord:
+                break;
+            }
+        });
+    }
+    if (!replayed) {
+        qWarning() << "Cannot replay order journal:" << journal->errorString();
+        return false;
+    }
+
+    m_snapshotPath = snapshotPath;
+    m_snapshotGeneration = generation;
+    m_journal = std::move(journal);
+
+    // First run: persist whatever is in memory as the initial snapshot
+    if (!hasSnapshot) {
+        compactJournal();
+    }
     return true;
 }
+
+void OrderManager::compactJournal() {
+    // A running load stages a snapshot of the orders that will replace these.
+    // Its finish handler publishes it and resets the journal, so leave it to that.
+    if (m_task && m_task->loading) return;
+
+    // The new generation voids the journal as soon as the snapshot is in place
+    const quint64 generation = m_snapshotGeneration + 1;
+    QString error;
+    if (!OrderSnapshot::write(m_snapshotPath, m_store.orders(), {}, generation, {}, &error)) {
+        qWarning() << "Order journal compaction failed:" << error;
+        return;
+    }
+    m_snapshotGeneration = generation;
+    m_journal->reset(generation);
+}
+
+void OrderManager::compactJournalIfNeeded() {
+    // Compacting costs O(N), so waiting for at least N records keeps appends amortised O(1)
+    if (m_journal->recordCount() >= qMax<qint64>(JournalCompactionThreshold, m_store.size())) {
+        compactJournal();
+    }
+}
@@ -4,12 +4,39 @@
 #include <QObject>
 #include <QList>
 #include <QSharedPointer>
+#include <QStringList>
+#include <QJsonObject>
+#include <QSet>
+#include <functional>
+#include <memory>
 #include "order.h"
+#include "orderstore.h"
+
+class OrderJournal;
+class QThread;
 
 class OrderManager : public QObject {
     Q_OBJECT
 
 public:
+    enum FileFormat {
+        JsonFormat,   // human-readable JSON array
+        BinaryFormat  // compact snapshot, see OrderSnapshot
+    };
+
+    // Groups mutations: while a Batch is alive the per-order signals are
+    // held back, and when the outermost one ends a single range notification
+    // and one dataChanged go out instead. Batches nest.
+    class Batch {
+    public:
+        explicit Batch(OrderManager* manager);
+        ~Batch();
+
+    private:
+        Q_DISABLE_COPY(Batch)
+        OrderManager* m_manager;
+    };
+
     explicit OrderManager(QObject *parent = nullptr);
     ~OrderManager();
 
@@ -18,12 +45,29 @@ public:
     void updateOrderStatus(const QString& id, Order::Status status);
     void deleteOrder(const QString& id);
 
+    // Batch operations, each one a single Batch
+    void addOrders(const QList<QSharedPointer<Order>>& orders);
+    void updateStatuses(const QStringList& ids, Order::Status status);
+
     // Query methods
     QList<QSharedPointer<Order>> getAllOrders() const;
     QList<QSharedPointer<Order>> getOrdersByCustomer(const QString& customerId) const;
     QList<QSharedPointer<Order>> getOrdersByStatus(Order::Status status) const;
     QList<QSharedPointer<Order>> getOrdersByDateRange(const QDateTime& from, const QDateTime& to) const;
     QSharedPointer<Order> getOrder(const QString& id);
+    QSharedPointer<Order> orderAt(int row) const; // row in getAllOrders()
+
+    // Paged queries in (date, id) order; they only build the rows of one page.
+    // Start with an empty token and continue with OrderPage::nextToken.
+    // Paged search results are in date order rather than ranked.
+    OrderPage getOrdersPage(const QString& token, int limit) const;
+    OrderPage getOrdersByCustomerPage(const QString& customerId, const QString& token, int limit) const;
+    OrderPage getOrdersByStatusPage(Order::Status status, const QString& token, int limit) const;
+    OrderPage searchOrdersPage(const QString& searchText, const QString& token, int limit) const;
+
+    // Composed filters, answered from the most selective index
+    QList<QSharedPointer<Order>> runQuery(const OrderQuery& query) const;
+    QString explainQuery(const OrderQuery& query) const;
 
     // Statistics methods
     double getTotalRevenue() const;
@@ -33,10 +77,34 @@ public:
     int getOrderCountByStatus(Order::Status status) const;
     double getAverageOrderValue() const;
 
-    // Persistence
-    bool saveToFile(const QString& filename) const;
+    // Revenue and order count per day, week, month, quarter or year;
+    // invalid dates leave the range open at that end
+    QList<OrderRollup::Bucket> getRevenueRollup(OrderRollup::Period period,
+                                                const QDate& from = QDate(), const QDate& to = QDate()) const;
+
+    // Persistence; both report persistenceProgress while they run.
+    // loadFromFile detects the format from the file contents.
+    bool saveToFile(const QString& filename, FileFormat format = JsonFormat);
     bool loadFromFile(const QString& filename);
 
+    // Same as above, but parsing, indexing and serialization run on a worker
+    // thread. A load replaces the current orders in one step once the worker
+    // is done. Only one operation runs at a time; these return false while
+    // another is in progress. Completion is reported by loadFinished/saveFinished.
+    bool loadFromFileAsync(const QString& filename);
+    bool saveToFileAsync(const QString& filename, FileFormat format = JsonFormat);
+    void cancelPersistence();
+    bool isPersistenceRunning() const;
+
+    // Durable storage: restores the snapshot in directory, replays its journal
+    // and from then on logs every mutation there
+    bool openJournal(const QString& directory);
+
+    // Off by default. When on, debug builds check the store's aggregates
+    // against a full O(N) recomputation after every batch and load; meant
+    // for tests, see OrderStore::checkConsistency.
+    void setConsistencyChecks(bool enabled) { m_consistencyChecks = enabled; }
+
     // Search
     QList<QSharedPointer<Order>> searchOrders(const QString& searchText) const;
 
@@ -46,11 +114,67 @@ signals:
     void orderDeleted(const QString& id);
     void dataChanged();
 
+    // Row-level notifications, one per batch (a lone mutation is a batch of one).
+    // Rows are positions in getAllOrders().
+    void ordersInserted(int first, int last);
+    void ordersUpdated(int first, int last); // smallest range covering every updated row
+    // A single removal: the order at row is gone and the former last row,
+    // movedFrom, took its place (movedFrom == row when the last row went)
+    void orderRemoved(int row, int movedFrom);
+    void ordersReset();                      // several rows removed or all replaced
+    void persistenceProgress(int percentage);
+    void loadFinished(bool ok, const QString& error);
+    void saveFinished(bool ok, const QString& error);
+
 private:
-    QList<QSharedPointer<Order>> m_orders;
+    // Returning false from a progress callback cancels the operation
+    using Progress = std::function<bool(qint64 done, qint64 total)>;
+    struct PersistenceTask;
+
+    OrderStore m_store;
+
+    // Changes collected by the running batch, reported when it ends
+    struct PendingChanges {
+        int insertedFrom = -1;
+        int updatedFirst = -1;
+        int updatedLast = -1;
+        int removedRow = -1;
+        int movedFrom = -1;
+        bool reset = false;
+        bool changed = false;
+    };
+    int m_batchDepth = 0;
+    PendingChanges m_pending;
+    bool m_consistencyChecks = false;
+
+    // Write-ahead journal, compacted into m_snapshotPath
+    std::unique_ptr<OrderJournal> m_journal;
+    QString m_snapshotPath;
+    quint64 m_snapshotGeneration = 0; // stamped on the journal, see OrderSnapshot
+    static constexpr qint64 JournalCompactionThreshold = 10000;
+
+    // Background load/save, see loadFromFileAsync
+    QThread* m_worker = nullptr;
+    std::shared_ptr<PersistenceTask> m_task;
 
     void loadSampleOrders();
-    int findOrderIndex(const QString& id) const;
+    void beginBatch();
+    void endBatch();
+    bool insertOrder(const QSharedPointer<Order>& order);
+    QSharedPointer<Order> setOrderStatus(const QString& id, Order::Status status);
+    static QJsonObject orderToJson(const Order& order, Order::Status status);
+    static QSharedPointer<Order> orderFromJson(const QJsonObject& orderObj, QSet<QString>& strings);
+    static QString intern(QSet<QString>& strings, const QString& text);
+    static bool readOrders(const QString& filename, QList<QSharedPointer<Order>>& orders,
+                           const Progress& progress, QString* error);
+    static bool writeOrders(const QString& filename, const QList<QSharedPointer<Order>>& orders,
+                            const QList<Order::Status>& statuses,
+                            FileFormat format, const Progress& progress, QString* error);
+    Progress progressReporter(const std::shared_ptr<PersistenceTask>& task = nullptr);
+    void startWorker(const std::shared_ptr<PersistenceTask>& task,
+                     std::function<void()> work, std::function<void()> finished);
+    void compactJournal();
+    void compactJournalIfNeeded();
 };
 
 #endif // ORDERMANAGER_H
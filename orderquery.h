@@ -0,0 +1,63 @@
+#ifndef ORDERQUERY_H
+#define ORDERQUERY_H
+
+#include <QDateTime>
+#include <QString>
+#include "order.h"
+
+// Conjunction of order filters, built up by chaining:
+//
+//   OrderQuery().customer("CUST1001").status(Order::Shipped).matching("laptop").limit(50)
+//
+// OrderManager::runQuery answers it by driving the scan from the most
+// selective index and checking the remaining filters per candidate.
+// Results are in (date, id) order.
+class OrderQuery {
+public:
+    OrderQuery& customer(const QString& customerId) {
+        m_customerId = customerId;
+        return *this;
+    }
+    OrderQuery& status(Order::Status status) {
+        m_status = status;
+        m_hasStatus = true;
+        return *this;
+    }
+    OrderQuery& between(const QDateTime& from, const QDateTime& to) {
+        m_from = from;
+        m_to = to;
+        return *this;
+    }
+    OrderQuery& matching(const QString& text) {
+        m_text = text;
+        return *this;
+    }
+    OrderQuery& limit(int count) {
+        m_limit = count;
+        return *this;
+    }
+
+    bool hasCustomer() const { return !m_customerId.isEmpty(); }
+    bool hasStatus() const { return m_hasStatus; }
+    bool hasDateRange() const { return m_from.isValid() && m_to.isValid(); }
+    bool hasText() const { return !m_text.isEmpty(); }
+    bool hasLimit() const { return m_limit >= 0; }
+
+    QString customerId() const { return m_customerId; }
+    Order::Status statusFilter() const { return m_status; }
+    QDateTime from() const { return m_from; }
+    QDateTime to() const { return m_to; }
+    QString text() const { return m_text; }
+    int limitCount() const { return m_limit; }
+
+private:
+    QString m_customerId;
+    Order::Status m_status = Order::Pending;
+    bool m_hasStatus = false;
+    QDateTime m_from;
+    QDateTime m_to;
+    QString m_text;
+    int m_limit = -1; // no limit
+};
+
+#endif // ORDERQUERY_H
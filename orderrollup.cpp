@@ -0,0 +1,129 @@
+#include "orderrollup.h"
+#include <algorithm>
+
+void OrderRollup::clear() {
+    for (auto& buckets : m_buckets) {
+        buckets.clear();
+    }
+    m_count = 0;
+    m_firstDay = 0;
+    m_tree.clear();
+}
+
+QDate OrderRollup::periodStart(Period period, const QDate& date) {
+    switch (period) {
+    case Day:
+        return date;
+    case Week:
+        return date.addDays(1 - date.dayOfWeek());
+    case Month:
+        return QDate(date.year(), date.month(), 1);
+    case Quarter:
+        return QDate(date.year(), (date.month() - 1) / 3 * 3 + 1, 1);
+    case Year:
+        return QDate(date.year(), 1, 1);
+    case PeriodCount:
+        break;
+    }
+    return date;
+}
+
+void OrderRollup::add(const QDate& date, double total) {
+    for (int period = 0; period < PeriodCount; ++period) {
+        Totals& totals = m_buckets[period][periodStart(Period(period), date).toJulianDay()];
+        totals.revenue += total;
+        totals.count++;
+    }
+    m_count++;
+    addDayRevenue(date, total);
+}
+
+void OrderRollup::remove(const QDate& date, double total) {
+    for (int period = 0; period < PeriodCount; ++period) {
+        auto it = m_buckets[period].find(periodStart(Period(period), date).toJulianDay());
+        if (it == m_buckets[period].end()) continue;
+
+        // Drop emptied buckets so no rounding residue is left behind
+        const double removed = it->count == 1 ? it->revenue : total;
+        if (--it->count == 0) {
+            m_buckets[period].erase(it);
+        } else {
+            it->revenue -= total;
+        }
+        if (period == Day) {
+            addDayRevenue(date, -removed);
+        }
+    }
+    m_count--;
+}
+
+QList<OrderRollup::Bucket> OrderRollup::buckets(Period period, const QDate& from, const QDate& to) const {
+    const QMap<qint64, Totals>& buckets = m_buckets[period];
+    auto it = from.isValid() ? buckets.lowerBound(periodStart(period, from).toJulianDay()) : buckets.constBegin();
+    const auto end = to.isValid() ? buckets.upperBound(to.toJulianDay()) : buckets.constEnd();
+
+    QList<Bucket> result;
+    for (; it != end; ++it) {
+        result.append({QDate::fromJulianDay(it.key()), it->revenue, it->count});
+    }
+    return result;
+}
+
+void OrderRollup::growTree(qint64 day) {
+    const qint64 oldSpan = qint64(m_tree.size()) - 1;
+    qint64 span = qMax<qint64>(512, oldSpan * 2);
+    if (m_tree.empty()) {
+        m_firstDay = day - span / 2;
+    } else {
+        const qint64 first = qMin(day, m_firstDay);
+        const qint64 last = qMax(day, m_firstDay + oldSpan - 1);
+        while (span < last - first + 1) {
+            span *= 2;
+        }
+        // Leave the new room on the side that ran out
+        m_firstDay = day < m_firstDay ? last - span + 1 : first;
+    }
+
+    // Linear build: fill in the day totals, then push each node into its parent
+    m_tree.assign(size_t(span) + 1, 0.0);
+    const QMap<qint64, Totals>& days = m_buckets[Day];
+    for (auto it = days.lowerBound(m_firstDay); it != days.constEnd() && it.key() < m_firstDay + span; ++it) {
+        m_tree[size_t(it.key() - m_firstDay) + 1] = it->revenue;
+    }
+    for (size_t i = 1; i < m_tree.size(); ++i) {
+        const size_t parent = i + (i & (~i + 1));
+        if (parent < m_tree.size()) {
+            m_tree[parent] += m_tree[i];
+        }
+    }
+}
+
+void OrderRollup::addDayRevenue(const QDate& date, double revenue) {
+    if (!date.isValid()) return;
+
+    const qint64 day = date.toJulianDay();
+    if (m_tree.empty() || day < m_firstDay || day >= m_firstDay + qint64(m_tree.size()) - 1) {
+        // The day bucket already holds this change, so the rebuild includes it
+        growTree(day);
+        return;
+    }
+    for (size_t i = size_t(day - m_firstDay) + 1; i < m_tree.size(); i += i & (~i + 1)) {
+        m_tree[i] += revenue;
+    }
+}
+
+// Revenue of all days before day
+double OrderRollup::revenueBefore(qint64 day) const {
+    if (m_tree.empty() || day <= m_firstDay) return 0;
+
+    double sum = 0;
+    for (size_t i = size_t(qMin(day - m_firstDay, qint64(m_tree.size()) - 1)); i > 0; i -= i & (~i + 1)) {
+        sum += m_tree[i];
+    }
+    return sum;
+}
+
+double OrderRollup::revenue(const QDate& first, const QDate& last) const {
+    if (!first.isValid() || !last.isValid() || first > last) return 0;
+    return revenueBefore(last.toJulianDay() + 1) - revenueBefore(first.toJulianDay());
+}
@@ -0,0 +1,63 @@
+#ifndef ORDERROLLUP_H
+#define ORDERROLLUP_H
+
+#include <QDate>
+#include <QList>
+#include <QMap>
+#include <vector>
+
+// Revenue and order counts pre-aggregated per day, week, month, quarter
+// and year, kept up to date as orders come and go. Whole-day ranges are
+// answered from a Fenwick tree over the days, which every change updates in
+// O(log days), so there is no rebuild after a mutation and const calls never
+// write.
+class OrderRollup {
+public:
+    enum Period {
+        Day,
+        Week,    // ISO weeks, starting on Monday
+        Month,
+        Quarter,
+        Year,
+        PeriodCount
+    };
+
+    struct Bucket {
+        QDate start; // first day of the period
+        double revenue = 0;
+        int count = 0;
+    };
+
+    void clear();
+    void add(const QDate& date, double total);
+    void remove(const QDate& date, double total);
+
+    // Buckets overlapping [from, to] in date order; an invalid date leaves that end open
+    QList<Bucket> buckets(Period period, const QDate& from, const QDate& to) const;
+
+    // Revenue of the whole days first..last, O(log days)
+    double revenue(const QDate& first, const QDate& last) const;
+    int count() const { return m_count; }
+
+    static QDate periodStart(Period period, const QDate& date);
+
+private:
+    struct Totals {
+        double revenue = 0;
+        int count = 0;
+    };
+
+    void addDayRevenue(const QDate& date, double revenue);
+    void growTree(qint64 day);
+    double revenueBefore(qint64 day) const;
+
+    QMap<qint64, Totals> m_buckets[PeriodCount]; // Julian day of the period start -> totals
+    int m_count = 0;
+
+    // Fenwick tree over the days m_firstDay.. m_firstDay + m_tree.size() - 2;
+    // m_tree[0] is unused. The span doubles when a date falls outside it.
+    qint64 m_firstDay = 0;
+    std::vector<double> m_tree;
+};
+
+#endif // ORDERROLLUP_H
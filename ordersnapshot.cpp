@@ -0,0 +1,330 @@
+#include "ordersnapshot.h"
+#include "productcatalog.h"
+#include <QHash>
+#include <QSaveFile>
+#include <cstring>
+#include <vector>
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "order snapshots are stored little-endian");
+
+namespace {
+
+const char Magic[8] = {'C', 'R', 'M', 'O', 'R', 'D', 'S', '\0'};
+
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 headerSize;
+    quint64 orderCount;
+    quint64 itemCount;
+    quint64 stringCount;
+    quint64 ordersOffset;
+    quint64 itemsOffset;
+    quint64 stringIndexOffset;
+    quint64 stringDataOffset;
+    quint64 generation; // version 2 on
+};
+
+constexpr quint32 HeaderSizeV1 = 72;
+
+struct OrderRecord {
+    qint64 orderDate; // msecs since epoch
+    quint32 id;
+    quint32 customerId;
+    quint32 customerName;
+    quint32 firstItem;
+    quint32 itemCount;
+    quint8 status;
+    quint8 reserved[3];
+};
+
+struct ItemRecord {
+    quint32 productName;
+    qint32 quantity;
+    double price;
+};
+
+struct StringEntry {
+    quint64 offset; // bytes from the start of the string data
+    quint32 length; // UTF-16 code units
+    quint32 reserved;
+};
+
+static_assert(sizeof(Header) == 80, "unexpected snapshot header size");
+static_assert(sizeof(OrderRecord) == 32, "unexpected order record size");
+static_assert(sizeof(ItemRecord) == 16, "unexpected item record size");
+static_assert(sizeof(StringEntry) == 16, "unexpected string entry size");
+
+bool setError(QString* error, const QString& message) {
+    if (error) *error = message;
+    return false;
+}
+
+template <typename T>
+bool writeRecord(QIODevice& device, const T& record) {
+    return device.write(reinterpret_cast<const char*>(&record), sizeof(T)) == qint64(sizeof(T));
+}
+
+// Reads the header of a version 1 or 2 file from data of the given size
+bool readHeader(const uchar* data, quint64 size, Header* header, QString* problem) {
+    *header = {};
+    if (size < HeaderSizeV1) {
+        *problem = QStringLiteral("file too small for an order snapshot");
+        return false;
+    }
+    std::memcpy(header, data, HeaderSizeV1);
+    if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0) {
+        *problem = QStringLiteral("not an order snapshot");
+        return false;
+    }
+    if (header->version == 1) return true;
+    if (header->version != OrderSnapshot::Version) {
+        *problem = QStringLiteral("unsupported snapshot version %1").arg(header->version);
+        return false;
+    }
+    if (size < sizeof(Header)) {
+        *problem = QStringLiteral("truncated order snapshot");
+        return false;
+    }
+    std::memcpy(header, data, sizeof(Header));
+    return true;
+}
+
+bool alignTo8(QIODevice& device) {
+    static const char padding[8] = {};
+    const qint64 gap = (8 - device.pos() % 8) % 8;
+    return gap == 0 || device.write(padding, gap) == gap;
+}
+
+// Assigns string table indices while the records are written
+class StringTable {
+public:
+    quint32 add(const QString& text) {
+        auto it = m_indices.constFind(text);
+        if (it != m_indices.constEnd()) return it.value();
+        const quint32 index = quint32(m_strings.size());
+        m_indices.insert(text, index);
+        m_strings.append(text);
+        return index;
+    }
+
+    const QStringList& strings() const { return m_strings; }
+
+private:
+    QHash<QString, quint32> m_indices;
+    QStringList m_strings;
+};
+
+} // namespace
+
+bool OrderSnapshot::isSnapshot(QIODevice* device) {
+    return device->peek(sizeof(Magic)) == QByteArray(Magic, sizeof(Magic));
+}
+
+bool OrderSnapshot::write(const QString& filename, const QList<QSharedPointer<Order>>& orders,
+                          const QList<Order::Status>& statuses, quint64 generation,
+                          const Progress& progress, QString* error) {
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return setError(error, file.errorString());
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.headerSize = sizeof(Header);
+    header.orderCount = orders.size();
+    header.generation = generation;
+
+    bool ok = writeRecord(file, header) && alignTo8(file);
+    const qint64 total = qint64(orders.size()) * 2;
+
+    StringTable strings;
+    header.ordersOffset = file.pos();
+    quint32 firstItem = 0;
+    for (int i = 0; ok && i < orders.size(); ++i) {
+        const Order& order = *orders[i];
+        OrderRecord record = {};
+        record.orderDate = order.orderDate().toMSecsSinceEpoch();
+        record.id = strings.add(order.id());
+        record.customerId = strings.add(order.customerId());
+        record.customerName = strings.add(order.customerName());
+        record.firstItem = firstItem;
+        record.itemCount = quint32(order.itemCount());
+        record.status = quint8(statuses.isEmpty() ? order.status() : statuses[i]);
+        firstItem += record.itemCount;
+        ok = writeRecord(file, record);
+        if (progress && !progress(i + 1, total)) {
+            return setError(error, QStringLiteral("cancelled"));
+        }
+    }
+
+    ok = ok && alignTo8(file);
+    header.itemsOffset = file.pos();
+    header.itemCount = firstItem;
+    QHash<int, quint32> productStrings; // catalog id -> string index
+    for (int i = 0; ok && i < orders.size(); ++i) {
+        for (const auto& item : orders[i]->items()) {
+            auto product = productStrings.constFind(item.productId);
+            if (product == productStrings.constEnd()) {
+                product = productStrings.insert(item.productId, strings.add(item.productName()));
+            }
+            ok = ok && writeRecord(file, ItemRecord{product.value(), item.quantity, item.price});
+        }
+        if (progress && !progress(orders.size() + i + 1, total)) {
+            return setError(error, QStringLiteral("cancelled"));
+        }
+    }
+
+    ok = ok && alignTo8(file);
+    header.stringCount = strings.strings().size();
+    header.stringIndexOffset = file.pos();
+    quint64 dataOffset = 0;
+    for (const QString& text : strings.strings()) {
+        StringEntry entry = {};
+        entry.offset = dataOffset;
+        entry.length = quint32(text.size());
+        dataOffset += quint64(text.size()) * sizeof(QChar);
+        ok = ok && writeRecord(file, entry);
+    }
+
+    header.stringDataOffset = file.pos();
+    for (const QString& text : strings.strings()) {
+        const qint64 bytes = text.size() * qint64(sizeof(QChar));
+        ok = ok && file.write(reinterpret_cast<const char*>(text.constData()), bytes) == bytes;
+    }
+
+    ok = ok && file.seek(0) && writeRecord(file, header);
+    if (!ok || !file.commit()) {
+        return setError(error, file.errorString());
+    }
+    return true;
+}
+
+bool OrderSnapshot::readGeneration(const QString& filename, quint64* generation) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const QByteArray data = file.read(sizeof(Header));
+    Header header;
+    QString problem;
+    if (!readHeader(reinterpret_cast<const uchar*>(data.constData()), quint64(data.size()), &header, &problem)) {
+        return false;
+    }
+    *generation = header.generation;
+    return true;
+}
+
+bool OrderSnapshot::read(QFile& file, QList<QSharedPointer<Order>>& orders,
+                         const Progress& progress, QString* error) {
+    const quint64 size = quint64(file.size());
+    if (size < HeaderSizeV1) {
+        return setError(error, QStringLiteral("file too small for an order snapshot"));
+    }
+
+    uchar* base = file.map(0, file.size());
+    if (!base) {
+        return setError(error, file.errorString());
+    }
+
+    // Every section has to lie inside the mapping before anything is read from it
+    auto fits = [size](quint64 offset, quint64 count, quint64 recordSize) {
+        return offset <= size && count <= (size - offset) / recordSize;
+    };
+    Header header;
+    QString problem;
+    if (readHeader(base, size, &header, &problem)
+        && (!fits(header.ordersOffset, header.orderCount, sizeof(OrderRecord))
+            || !fits(header.itemsOffset, header.itemCount, sizeof(ItemRecord))
+            || !fits(header.stringIndexOffset, header.stringCount, sizeof(StringEntry))
+            || header.stringDataOffset > size)) {
+        problem = QStringLiteral("truncated order snapshot");
+    }
+    if (!problem.isEmpty()) {
+        file.unmap(base);
+        return setError(error, problem);
+    }
+
+    const uchar* stringIndex = base + header.stringIndexOffset;
+    const uchar* stringData = base + header.stringDataOffset;
+    const quint64 stringDataSize = size - header.stringDataOffset;
+
+    // Strings are decoded on first use only and then shared between orders
+    std::vector<QString> stringCache(header.stringCount);
+    std::vector<bool> decoded(header.stringCount, false);
+    auto string = [&](quint32 index, bool* valid) -> QString {
+        if (index >= header.stringCount) {
+            *valid = false;
+            return QString();
+        }
+        if (!decoded[index]) {
+            StringEntry entry;
+            std::memcpy(&entry, stringIndex + quint64(index) * sizeof(StringEntry), sizeof(StringEntry));
+            if (entry.offset > stringDataSize || entry.length > (stringDataSize - entry.offset) / sizeof(QChar)) {
+                *valid = false;
+                return QString();
+            }
+            QString text(entry.length, Qt::Uninitialized);
+            std::memcpy(text.data(), stringData + entry.offset, entry.length * sizeof(QChar));
+            stringCache[index] = text;
+            decoded[index] = true;
+        }
+        return stringCache[index];
+    };
+    std::vector<int> productIds(header.stringCount, -1);
+
+    QList<QSharedPointer<Order>> loaded;
+    loaded.reserve(qsizetype(header.orderCount));
+    bool valid = true;
+    bool cancelled = false;
+    for (quint64 i = 0; valid && !cancelled && i < header.orderCount; ++i) {
+        OrderRecord record;
+        std::memcpy(&record, base + header.ordersOffset + i * sizeof(OrderRecord), sizeof(OrderRecord));
+        if (quint64(record.firstItem) + record.itemCount > header.itemCount) {
+            valid = false;
+            break;
+        }
+
+        auto order = QSharedPointer<Order>::create(string(record.id, &valid),
+                                                   string(record.customerId, &valid),
+                                                   QDateTime::fromMSecsSinceEpoch(record.orderDate));
+        order->setCustomerName(string(record.customerName, &valid));
+        order->setStatus(record.status < Order::StatusCount ? Order::Status(record.status) : Order::Pending);
+        order->reserveItems(int(record.itemCount)); // bounded by the check above
+
+        for (quint32 j = 0; valid && j < record.itemCount; ++j) {
+            ItemRecord itemRecord;
+            std::memcpy(&itemRecord,
+                        base + header.itemsOffset + (quint64(record.firstItem) + j) * sizeof(ItemRecord),
+                        sizeof(ItemRecord));
+            if (itemRecord.productName >= header.stringCount) {
+                valid = false;
+                break;
+            }
+            int& productId = productIds[itemRecord.productName];
+            if (productId < 0) {
+                productId = ProductCatalog::instance().intern(string(itemRecord.productName, &valid));
+            }
+
+            OrderItem item;
+            item.productId = productId;
+            item.quantity = itemRecord.quantity;
+            item.price = itemRecord.price;
+            order->addItem(item);
+        }
+
+        loaded.append(order);
+        cancelled = progress && !progress(qint64(i + 1), qint64(header.orderCount));
+    }
+
+    file.unmap(base);
+    if (cancelled) {
+        return setError(error, QStringLiteral("cancelled"));
+    }
+    if (!valid) {
+        return setError(error, QStringLiteral("corrupt order snapshot"));
+    }
+
+    orders = std::move(loaded);
+    return true;
+}
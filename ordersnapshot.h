@@ -0,0 +1,46 @@
+#ifndef ORDERSNAPSHOT_H
+#define ORDERSNAPSHOT_H
+
+#include <QFile>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <functional>
+#include "order.h"
+
+// Versioned binary snapshot of a set of orders.
+//
+// Layout (little-endian, every section 8-byte aligned):
+//   Header
+//   OrderRecord[orderCount]   fixed width, so order i is at a known offset
+//   ItemRecord[itemCount]     items of an order are contiguous
+//   StringEntry[stringCount]  offset index into the string data
+//   UTF-16 string data        every distinct string stored once
+//
+// Loading memory-maps the file and decodes each string table entry at most
+// once, so repeated customer and product names share one QString.
+//
+// The header carries a generation number. OrderManager stamps its journal
+// with the same number, so a journal left over from an older snapshot is
+// recognised and not replayed onto a newer one. Version 1 files have none
+// and read as generation 0.
+class OrderSnapshot {
+public:
+    // Called as records are processed; returning false cancels the operation
+    using Progress = std::function<bool(qint64 done, qint64 total)>;
+
+    static constexpr quint32 Version = 2;
+
+    static bool isSnapshot(QIODevice* device);
+    // statuses, when not empty, overrides the status of each order, so a
+    // worker can write orders whose status the GUI thread may still change
+    static bool write(const QString& filename, const QList<QSharedPointer<Order>>& orders,
+                      const QList<Order::Status>& statuses, quint64 generation,
+                      const Progress& progress, QString* error);
+    static bool read(QFile& file, QList<QSharedPointer<Order>>& orders,
+                     const Progress& progress, QString* error);
+    // Reads only the header; false if filename is not a readable snapshot
+    static bool readGeneration(const QString& filename, quint64* generation);
+};
+
+#endif // ORDERSNAPSHOT_H
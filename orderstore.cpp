@@ -0,0 +1,538 @@
+#include "orderstore.h"
+#include <QDebug>
+#include <QStringList>
+#include <QtMath>
+#include <algorithm>
+#include <vector>
+
+void OrderStore::clear() {
+    m_orders.clear();
+    m_idIndex.clear();
+    m_dateIndex.clear();
+    m_customerIndex.clear();
+    for (auto& bucket : m_statusIndex) {
+        bucket.clear();
+    }
+    m_totalRevenue = 0;
+    m_customerRevenue.clear();
+    m_columns.clear();
+    m_searchIndex.clear();
+    m_rollup.clear();
+}
+
+void OrderStore::reserve(int count) {
+    m_orders.reserve(count);
+    m_idIndex.reserve(count);
+    m_columns.reserve(count);
+    m_searchIndex.reserve(count);
+}
+
+bool OrderStore::insert(const QSharedPointer<Order>& order) {
+    if (m_idIndex.contains(order->id())) {
+        qWarning() << "Duplicate order id ignored:" << order->id();
+        return false;
+    }
+
+    m_idIndex.insert(order->id(), m_orders.size());
+    m_orders.append(order);
+    m_columns.append(*order);
+    indexOrder(order);
+    return true;
+}
+
+bool OrderStore::remove(const QString& id) {
+    const int index = indexOf(id);
+    if (index < 0) return false;
+
+    unindexOrder(m_orders[index]);
+
+    // Swap-remove so no other order changes position except the last one
+    const int last = m_orders.size() - 1;
+    if (index != last) {
+        m_orders[index] = m_orders[last];
+        m_idIndex[m_orders[index]->id()] = index;
+    }
+    m_orders.removeLast();
+    m_columns.removeAt(index);
+    m_idIndex.remove(id);
+    return true;
+}
+
+QSharedPointer<Order> OrderStore::setStatus(const QString& id, Order::Status status) {
+    const int index = indexOf(id);
+    if (index < 0) return nullptr;
+
+    const QSharedPointer<Order>& order = m_orders[index];
+    if (order->status() != status) {
+        const OrderKey key = keyOf(*order);
+        m_statusIndex[order->status()].remove(key);
+        order->setStatus(status);
+        m_statusIndex[status].insert(key, order);
+        m_columns.setStatus(index, status);
+        // Only the status word differs, and a replacement only re-indexes
+        // the trigrams that changed
+        m_searchIndex.insert(order->id(), searchTextOf(*order));
+    }
+    return order;
+}
+
+QSharedPointer<Order> OrderStore::order(const QString& id) const {
+    const int index = indexOf(id);
+    return (index >= 0) ? m_orders[index] : nullptr;
+}
+
+OrderStore::OrderKey OrderStore::keyOf(const Order& order) {
+    return {order.orderDate().toMSecsSinceEpoch(), order.id()};
+}
+
+QString OrderStore::searchTextOf(const Order& order) {
+    // Fields are joined with a control character so a match cannot span two of them.
+    // The id comes first, so id matches rank ahead of name and product matches.
+    QStringList fields{order.id(), order.customerName()};
+    for (const auto& item : order.items()) {
+        fields.append(item.productName());
+    }
+    fields.append(Order::statusToString(order.status()));
+    return fields.join(QChar(0x1f));
+}
+
+// Where needle, already lowercased, occurs in searchTextOf(order), found field
+// by field so the text never has to be built. A needle cannot contain the
+// separator, so no match spans two fields either way.
+qsizetype OrderStore::findText(const Order& order, const QString& needle) {
+    qsizetype offset = 0;
+    auto find = [&](const QString& field) {
+        const qsizetype pos = field.indexOf(needle, 0, Qt::CaseInsensitive);
+        if (pos >= 0) return offset + pos;
+        offset += field.size() + 1;
+        return qsizetype(-1);
+    };
+
+    qsizetype pos = find(order.id());
+    if (pos < 0) pos = find(order.customerName());
+    for (int i = 0; pos < 0 && i < order.itemCount(); ++i) {
+        pos = find(order.items()[i].productName());
+    }
+    if (pos < 0) pos = find(Order::statusToString(order.status()));
+    return pos;
+}
+
+TrigramIndex::Matcher OrderStore::textMatcher() const {
+    return [this](const QString& id, const QString& needle) {
+        const int index = indexOf(id);
+        return index >= 0 ? findText(*m_orders[index], needle) : qsizetype(-1);
+    };
+}
+
+void OrderStore::indexOrder(const QSharedPointer<Order>& order) {
+    const OrderKey key = keyOf(*order);
+    m_dateIndex.insert(key, order);
+    m_customerIndex[order->customerId()].insert(key, order);
+    m_statusIndex[order->status()].insert(key, order);
+    m_searchIndex.insert(order->id(), searchTextOf(*order));
+
+    const double total = order->total();
+    m_totalRevenue += total;
+    m_customerRevenue[order->customerId()] += total;
+    m_rollup.add(dayOf(order->orderDate()), total);
+}
+
+void OrderStore::unindexOrder(const QSharedPointer<Order>& order) {
+    const OrderKey key = keyOf(*order);
+    m_dateIndex.remove(key);
+
+    auto customer = m_customerIndex.find(order->customerId());
+    if (customer != m_customerIndex.end()) {
+        customer->remove(key);
+        if (customer->isEmpty()) {
+            m_customerIndex.erase(customer);
+        }
+    }
+
+    m_statusIndex[order->status()].remove(key);
+    m_searchIndex.remove(order->id());
+
+    // Reset instead of subtracting once a total has nothing left, so
+    // rounding error cannot accumulate across add/delete cycles
+    const double total = order->total();
+    m_rollup.remove(dayOf(order->orderDate()), total);
+    if (m_dateIndex.isEmpty()) {
+        m_totalRevenue = 0;
+    } else {
+        m_totalRevenue -= total;
+    }
+    if (m_customerIndex.contains(order->customerId())) {
+        m_customerRevenue[order->customerId()] -= total;
+    } else {
+        m_customerRevenue.remove(order->customerId());
+    }
+}
+
+void OrderStore::checkConsistency() const {
+#ifndef QT_NO_DEBUG
+    // Debug builds only: compare the running aggregates with a full recomputation
+    double revenue = 0;
+    QHash<QString, double> customerRevenue;
+    int statusCounts[Order::StatusCount] = {};
+    for (const auto& order : m_orders) {
+        const double total = order->total();
+        revenue += total;
+        customerRevenue[order->customerId()] += total;
+        statusCounts[order->status()]++;
+    }
+
+    auto matches = [](double a, double b) {
+        return qAbs(a - b) <= 1e-6 * qMax(1.0, qMax(qAbs(a), qAbs(b)));
+    };
+
+    Q_ASSERT_X(matches(revenue, m_totalRevenue), "OrderStore", "total revenue out of sync");
+    Q_ASSERT_X(customerRevenue.size() == m_customerRevenue.size(), "OrderStore", "customer revenue out of sync");
+    for (auto it = customerRevenue.constBegin(); it != customerRevenue.constEnd(); ++it) {
+        Q_ASSERT_X(matches(it.value(), m_customerRevenue.value(it.key())), "OrderStore", "customer revenue out of sync");
+    }
+    for (int status = 0; status < Order::StatusCount; ++status) {
+        Q_ASSERT_X(statusCounts[status] == m_statusIndex[status].size(), "OrderStore", "status count out of sync");
+        Q_ASSERT_X(statusCounts[status] == m_columns.countByStatus(static_cast<Order::Status>(status)),
+                   "OrderStore", "status column out of sync");
+    }
+    Q_ASSERT_X(m_columns.size() == m_orders.size(), "OrderStore", "column store out of sync");
+    Q_ASSERT_X(m_rollup.count() == m_orders.size(), "OrderStore", "rollup out of sync");
+#endif
+}
+
+OrderStore::IndexRange OrderStore::dateRange(const QDateTime& from, const QDateTime& to) const {
+    return keyRange(m_dateIndex, from, to);
+}
+
+OrderStore::IndexRange OrderStore::keyRange(const OrderIndex& index, const QDateTime& from, const QDateTime& to) {
+    if (from > to) {
+        return {index.constEnd(), index.constEnd()};
+    }
+    // Keys with an empty id sort before every real order at the same timestamp
+    return {index.lowerBound({from.toMSecsSinceEpoch(), QString()}),
+            index.lowerBound({to.toMSecsSinceEpoch() + 1, QString()})};
+}
+
+OrderStore::IndexRange OrderStore::queryRange(const OrderIndex& index, const OrderQuery& query) {
+    // Every index is ordered by date, so a date filter narrows any of them
+    return query.hasDateRange() ? keyRange(index, query.from(), query.to())
+                                : IndexRange{index.constBegin(), index.constEnd()};
+}
+
+QList<QSharedPointer<Order>> OrderStore::byCustomer(const QString& customerId) const {
+    return m_customerIndex.value(customerId).values();
+}
+
+QList<QSharedPointer<Order>> OrderStore::byStatus(Order::Status status) const {
+    return m_statusIndex[status].values();
+}
+
+QList<QSharedPointer<Order>> OrderStore::byDateRange(const QDateTime& from, const QDateTime& to) const {
+    QList<QSharedPointer<Order>> results;
+    const auto range = dateRange(from, to);
+    for (auto it = range.first; it != range.second; ++it) {
+        results.append(it.value());
+    }
+    return results;
+}
+
+QList<QSharedPointer<Order>> OrderStore::search(const QString& text) const {
+    // Ranked by where the text matches: id hits first, then names, products, status
+    const QStringList ids = m_searchIndex.search(text, textMatcher());
+
+    QList<QSharedPointer<Order>> results;
+    results.reserve(ids.size());
+    for (const QString& id : ids) {
+        const int index = indexOf(id);
+        if (index >= 0) {
+            results.append(m_orders[index]);
+        }
+    }
+    return results;
+}
+
+QString OrderStore::tokenOf(const OrderKey& key) {
+    return QString::number(key.date) + QLatin1Char(':') + key.id;
+}
+
+bool OrderStore::keyFromToken(const QString& token, OrderKey& key) {
+    // Ids may contain ':' themselves, so split at the first one only
+    const qsizetype separator = token.indexOf(QLatin1Char(':'));
+    if (separator <= 0) return false;
+
+    bool ok = false;
+    key.date = token.left(separator).toLongLong(&ok);
+    key.id = token.mid(separator + 1);
+    return ok;
+}
+
+OrderPage OrderStore::pageOf(const OrderIndex& index, const QString& token, int limit) {
+    OrderPage page;
+    auto it = index.constBegin();
+    if (!token.isEmpty()) {
+        OrderKey after;
+        if (!keyFromToken(token, after)) {
+            qWarning() << "Invalid order page token:" << token;
+            return page;
+        }
+        // The order the token points at may be gone by now; upperBound does not need it
+        it = index.upperBound(after);
+    }
+
+    page.orders.reserve(qMin<qsizetype>(limit, index.size()));
+    for (; it != index.constEnd() && page.orders.size() < limit; ++it) {
+        page.orders.append(it.value());
+    }
+    if (it != index.constEnd() && !page.orders.isEmpty()) {
+        page.nextToken = tokenOf(keyOf(*page.orders.last()));
+    }
+    return page;
+}
+
+OrderPage OrderStore::page(const QString& token, int limit) const {
+    return pageOf(m_dateIndex, token, limit);
+}
+
+OrderPage OrderStore::customerPage(const QString& customerId, const QString& token, int limit) const {
+    auto customer = m_customerIndex.constFind(customerId);
+    if (customer == m_customerIndex.constEnd()) return OrderPage();
+    return pageOf(customer.value(), token, limit);
+}
+
+OrderPage OrderStore::statusPage(Order::Status status, const QString& token, int limit) const {
+    return pageOf(m_statusIndex[status], token, limit);
+}
+
+OrderPage OrderStore::searchPage(const QString& text, const QString& token, int limit) const {
+    // Matches come back by relevance, so they are re-sorted into key order.
+    // Only the rows after the token are considered, and only the first limit + 1 are sorted.
+    OrderKey after{0, QString()};
+    if (!token.isEmpty() && !keyFromToken(token, after)) {
+        qWarning() << "Invalid order page token:" << token;
+        return OrderPage();
+    }
+
+    std::vector<std::pair<OrderKey, int>> matches;
+    for (const QString& id : m_searchIndex.search(text, textMatcher())) {
+        const int index = indexOf(id);
+        if (index < 0) continue;
+
+        OrderKey key = keyOf(*m_orders[index]);
+        if (token.isEmpty() || after < key) {
+            matches.emplace_back(std::move(key), index);
+        }
+    }
+
+    auto byKey = [](const std::pair<OrderKey, int>& a, const std::pair<OrderKey, int>& b) {
+        return a.first < b.first;
+    };
+    const bool hasMore = matches.size() > size_t(qMax(limit, 0));
+    const auto end = hasMore ? matches.begin() + qMax(limit, 0) : matches.end();
+    std::partial_sort(matches.begin(), end, matches.end(), byKey);
+
+    OrderPage page;
+    page.orders.reserve(end - matches.begin());
+    for (auto it = matches.begin(); it != end; ++it) {
+        page.orders.append(m_orders[it->second]);
+    }
+    if (hasMore && !page.orders.isEmpty()) {
+        page.nextToken = tokenOf((end - 1)->first);
+    }
+    return page;
+}
+
+OrderStore::QueryPlan OrderStore::plan(const OrderQuery& query) const {
+    static const OrderIndex empty;
+    QueryPlan best;
+    best.index = &m_dateIndex;
+    best.estimate = m_orders.size();
+
+    auto consider = [&best](QueryPlan::Driver driver, const OrderIndex* index, qint64 estimate,
+                            const QString& description) {
+        best.candidates.append(QStringLiteral("%1: ~%2 rows").arg(description).arg(estimate));
+        if (estimate < best.estimate) {
+            best.driver = driver;
+            best.index = index;
+            best.estimate = estimate;
+        }
+    };
+
+    // Without dates the whole index qualifies and its size is the count. Counting
+    // a range means walking it, so it stops once it cannot beat the best path so far.
+    auto countRange = [&query, &best](const OrderIndex& index) -> qint64 {
+        if (!query.hasDateRange()) return index.size();
+
+        const IndexRange range = queryRange(index, query);
+        qint64 count = 0;
+        for (auto it = range.first; it != range.second && count <= best.estimate; ++it) {
+            ++count;
+        }
+        return count;
+    };
+
+    // Cheap upper bounds first, so the range walks below are capped early
+    if (query.hasText()) {
+        consider(QueryPlan::TextDriver, nullptr, m_searchIndex.estimate(query.text()),
+                 QStringLiteral("text index \"%1\"").arg(query.text()));
+    }
+    const OrderIndex* customer = nullptr;
+    if (query.hasCustomer()) {
+        auto it = m_customerIndex.constFind(query.customerId());
+        customer = it != m_customerIndex.constEnd() ? &it.value() : &empty;
+    }
+    const OrderIndex* status = query.hasStatus() ? &m_statusIndex[query.statusFilter()] : nullptr;
+    const QString withinDates = query.hasDateRange() ? QStringLiteral(" within dates") : QString();
+
+    if (customer) {
+        consider(QueryPlan::CustomerDriver, customer, countRange(*customer),
+                 QStringLiteral("customer index [%1]%2").arg(query.customerId(), withinDates));
+    }
+    if (status) {
+        consider(QueryPlan::StatusDriver, status, countRange(*status),
+                 QStringLiteral("status index [%1]%2").arg(Order::statusToString(query.statusFilter()), withinDates));
+    }
+    if (query.hasDateRange()) {
+        consider(QueryPlan::DateDriver, &m_dateIndex, countRange(m_dateIndex), QStringLiteral("date index range"));
+    }
+    return best;
+}
+
+QList<QSharedPointer<Order>> OrderStore::select(const OrderQuery& query) const {
+    const QueryPlan queryPlan = plan(query);
+    const QString needle = query.text().toLower();
+    const int limit = query.hasLimit() ? query.limitCount() : m_orders.size();
+
+    // Filters the driving index has not already applied
+    auto accept = [&](const Order& order) {
+        if (query.hasCustomer() && queryPlan.driver != QueryPlan::CustomerDriver
+            && order.customerId() != query.customerId()) {
+            return false;
+        }
+        if (query.hasStatus() && queryPlan.driver != QueryPlan::StatusDriver
+            && order.status() != query.statusFilter()) {
+            return false;
+        }
+        if (query.hasText() && queryPlan.driver != QueryPlan::TextDriver
+            && findText(order, needle) < 0) {
+            return false;
+        }
+        return true;
+    };
+
+    QList<QSharedPointer<Order>> results;
+    if (queryPlan.driver != QueryPlan::TextDriver) {
+        // Index order is already the result order, so the walk stops at the limit
+        const IndexRange range = queryRange(*queryPlan.index, query);
+        for (auto it = range.first; it != range.second && results.size() < limit; ++it) {
+            if (accept(*it.value())) {
+                results.append(it.value());
+            }
+        }
+        return results;
+    }
+
+    std::vector<std::pair<OrderKey, int>> matches;
+    for (const QString& id : m_searchIndex.search(query.text(), textMatcher())) {
+        const int index = indexOf(id);
+        if (index < 0) continue;
+
+        const Order& order = *m_orders[index];
+        const qint64 date = order.orderDate().toMSecsSinceEpoch();
+        if (query.hasDateRange() && (date < query.from().toMSecsSinceEpoch()
+                                     || date > query.to().toMSecsSinceEpoch())) {
+            continue;
+        }
+        if (accept(order)) {
+            matches.emplace_back(keyOf(order), index);
+        }
+    }
+
+    const auto end = matches.begin() + qMin<qsizetype>(qMax(limit, 0), matches.size());
+    std::partial_sort(matches.begin(), end, matches.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+    results.reserve(end - matches.begin());
+    for (auto it = matches.begin(); it != end; ++it) {
+        results.append(m_orders[it->second]);
+    }
+    return results;
+}
+
+QString OrderStore::explain(const OrderQuery& query) const {
+    const QueryPlan queryPlan = plan(query);
+
+    QStringList lines;
+    switch (queryPlan.driver) {
+    case QueryPlan::DateDriver:
+        lines.append(query.hasDateRange() ? QStringLiteral("scan date index range") : QStringLiteral("scan all orders by date"));
+        break;
+    case QueryPlan::CustomerDriver:
+        lines.append(QStringLiteral("scan customer index [%1]").arg(query.customerId()));
+        break;
+    case QueryPlan::StatusDriver:
+        lines.append(QStringLiteral("scan status index [%1]").arg(Order::statusToString(query.statusFilter())));
+        break;
+    case QueryPlan::TextDriver:
+        lines.append(QStringLiteral("probe text index \"%1\", then sort by date").arg(query.text()));
+        break;
+    }
+    lines.last() += QStringLiteral(" (~%1 rows)").arg(queryPlan.estimate);
+
+    QStringList filters;
+    if (query.hasCustomer() && queryPlan.driver != QueryPlan::CustomerDriver) {
+        filters.append(QStringLiteral("customer = %1").arg(query.customerId()));
+    }
+    if (query.hasStatus() && queryPlan.driver != QueryPlan::StatusDriver) {
+        filters.append(QStringLiteral("status = %1").arg(Order::statusToString(query.statusFilter())));
+    }
+    if (query.hasDateRange() && queryPlan.driver == QueryPlan::TextDriver) {
+        filters.append(QStringLiteral("date in range"));
+    }
+    if (query.hasText() && queryPlan.driver != QueryPlan::TextDriver) {
+        filters.append(QStringLiteral("text contains \"%1\"").arg(query.text()));
+    }
+    if (query.hasDateRange() && queryPlan.driver != QueryPlan::TextDriver) {
+        lines.append(QStringLiteral("  range: %1 .. %2").arg(query.from().toString(Qt::ISODate),
+                                                            query.to().toString(Qt::ISODate)));
+    }
+    if (!filters.isEmpty()) {
+        lines.append(QStringLiteral("  filter: ") + filters.join(QStringLiteral(", ")));
+    }
+    if (query.hasLimit()) {
+        lines.append(QStringLiteral("  limit: %1").arg(query.limitCount()));
+    }
+    if (!queryPlan.candidates.isEmpty()) {
+        lines.append(QStringLiteral("  considered: ") + queryPlan.candidates.join(QStringLiteral("; ")));
+    }
+    return lines.join(QLatin1Char('\n'));
+}
+
+double OrderStore::revenueByDateRange(const QDateTime& from, const QDateTime& to) const {
+    if (from > to) return 0;
+
+    // Whole days in between come from the rollup's Fenwick tree. Only the
+    // boundary days, which the range may cover in part, are scanned.
+    const QDate firstDay = dayOf(from);
+    const QDate lastDay = dayOf(to);
+    if (firstDay == lastDay) {
+        return scanRevenue(from, to);
+    }
+    return scanRevenue(from, firstDay.addDays(1).startOfDay().addMSecs(-1))
+           + m_rollup.revenue(firstDay.addDays(1), lastDay.addDays(-1))
+           + scanRevenue(lastDay.startOfDay(), to);
+}
+
+double OrderStore::scanRevenue(const QDateTime& from, const QDateTime& to) const {
+    // Narrow ranges are cheapest through the date index. Once a range turns
+    // out to cover a sizeable share of the orders, scan the columns instead.
+    const int budget = qMax(64, int(m_orders.size() / 16));
+    int visited = 0;
+    double total = 0;
+    const auto range = dateRange(from, to);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (++visited > budget) {
+            return m_columns.revenueInRange(from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch());
+        }
+        total += it.value()->total();
+    }
+    return total;
+}
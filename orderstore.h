@@ -0,0 +1,133 @@
+#ifndef ORDERSTORE_H
+#define ORDERSTORE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include "order.h"
+#include "ordercolumnstore.h"
+#include "orderquery.h"
+#include "orderrollup.h"
+#include "trigramindex.h"
+
+// One page of a paged query. Rows come in (date, id) order, which does not
+// change as other orders are added or removed. nextToken is empty on the
+// last page; otherwise pass it back to fetch the next page.
+struct OrderPage {
+    QList<QSharedPointer<Order>> orders;
+    QString nextToken;
+};
+
+// The orders held by OrderManager together with every index and aggregate
+// derived from them. It has no signals and no thread affinity, so a worker
+// thread can build a complete store that OrderManager then swaps in.
+class OrderStore {
+public:
+    void clear();
+    void reserve(int count);
+
+    // Mutations; each keeps all indexes and aggregates in step
+    bool insert(const QSharedPointer<Order>& order); // false for a duplicate id
+    bool remove(const QString& id);
+    QSharedPointer<Order> setStatus(const QString& id, Order::Status status);
+
+    int size() const { return m_orders.size(); }
+    int indexOf(const QString& id) const { return m_idIndex.value(id, -1); }
+    const QList<QSharedPointer<Order>>& orders() const { return m_orders; }
+    QSharedPointer<Order> order(const QString& id) const;
+
+    // Queries
+    QList<QSharedPointer<Order>> byCustomer(const QString& customerId) const;
+    QList<QSharedPointer<Order>> byStatus(Order::Status status) const;
+    QList<QSharedPointer<Order>> byDateRange(const QDateTime& from, const QDateTime& to) const;
+    QList<QSharedPointer<Order>> search(const QString& text) const;
+
+    // Paged queries; an empty token starts at the first page
+    OrderPage page(const QString& token, int limit) const;
+    OrderPage customerPage(const QString& customerId, const QString& token, int limit) const;
+    OrderPage statusPage(Order::Status status, const QString& token, int limit) const;
+    OrderPage searchPage(const QString& text, const QString& token, int limit) const;
+
+    // Composed filters, see OrderQuery. explain() describes the plan select() would use.
+    QList<QSharedPointer<Order>> select(const OrderQuery& query) const;
+    QString explain(const OrderQuery& query) const;
+
+    // Aggregates
+    double totalRevenue() const { return m_totalRevenue; }
+    double revenueByCustomer(const QString& customerId) const { return m_customerRevenue.value(customerId, 0.0); }
+    double revenueByDateRange(const QDateTime& from, const QDateTime& to) const;
+    QList<OrderRollup::Bucket> rollup(OrderRollup::Period period, const QDate& from, const QDate& to) const {
+        return m_rollup.buckets(period, from, to);
+    }
+    int countByStatus(Order::Status status) const { return m_statusIndex[status].size(); }
+
+    // Debug builds: asserts that the aggregates match a full recomputation.
+    // O(N), so callers only run it on request.
+    void checkConsistency() const;
+
+private:
+    // Sort key of the ordered indexes: order date, then id as tie-breaker
+    struct OrderKey {
+        qint64 date;
+        QString id;
+
+        bool operator<(const OrderKey& other) const {
+            return date != other.date ? date < other.date : id < other.id;
+        }
+    };
+    using OrderIndex = QMap<OrderKey, QSharedPointer<Order>>;
+    using IndexRange = QPair<OrderIndex::const_iterator, OrderIndex::const_iterator>;
+
+    // Access path chosen for an OrderQuery and the row counts behind the choice
+    struct QueryPlan {
+        enum Driver { DateDriver, CustomerDriver, StatusDriver, TextDriver };
+        Driver driver = DateDriver;
+        const OrderIndex* index = nullptr; // null for TextDriver
+        qint64 estimate = 0;
+        QStringList candidates;
+    };
+
+    static OrderKey keyOf(const Order& order);
+    static QDate dayOf(const QDateTime& dateTime) { return dateTime.toLocalTime().date(); }
+    double scanRevenue(const QDateTime& from, const QDateTime& to) const;
+    static QString tokenOf(const OrderKey& key);
+    static bool keyFromToken(const QString& token, OrderKey& key);
+    static OrderPage pageOf(const OrderIndex& index, const QString& token, int limit);
+    static QString searchTextOf(const Order& order);
+    static qsizetype findText(const Order& order, const QString& needle);
+    TrigramIndex::Matcher textMatcher() const;
+    void indexOrder(const QSharedPointer<Order>& order);
+    void unindexOrder(const QSharedPointer<Order>& order);
+    IndexRange dateRange(const QDateTime& from, const QDateTime& to) const;
+    static IndexRange keyRange(const OrderIndex& index, const QDateTime& from, const QDateTime& to);
+    static IndexRange queryRange(const OrderIndex& index, const OrderQuery& query);
+    QueryPlan plan(const OrderQuery& query) const;
+
+    QList<QSharedPointer<Order>> m_orders;
+    QHash<QString, int> m_idIndex; // order id -> position in m_orders
+
+    // Secondary indexes, each ordered by date
+    OrderIndex m_dateIndex;
+    QHash<QString, OrderIndex> m_customerIndex;
+    OrderIndex m_statusIndex[Order::StatusCount];
+
+    // Running aggregates; status counts come from the status buckets
+    double m_totalRevenue = 0;
+    QHash<QString, double> m_customerRevenue;
+
+    // Columnar mirror of m_orders for wide scans
+    OrderColumnStore m_columns;
+
+    // Substring index over id, customer name, product names and status. It
+    // keeps no text; candidates are checked against the orders themselves.
+    TrigramIndex m_searchIndex{false};
+
+    // Per-period revenue and counts, bucketed by local calendar day
+    OrderRollup m_rollup;
+};
+
+#endif // ORDERSTORE_H
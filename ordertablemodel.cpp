@@ -0,0 +1,160 @@
+#include "ordertablemodel.h"
+#include "ordermanager.h"
+#include <QColor>
+
+OrderTableModel::OrderTableModel(OrderManager* orderManager, QObject *parent)
+    : QAbstractTableModel(parent), m_orderManager(orderManager)
+{
+    m_rowCount = m_orderManager->getTotalOrderCount();
+
+    connect(m_orderManager, &OrderManager::ordersInserted, this, &OrderTableModel::onOrdersInserted);
+    connect(m_orderManager, &OrderManager::ordersUpdated, this, &OrderTableModel::onOrdersUpdated);
+    connect(m_orderManager, &OrderManager::orderRemoved, this, &OrderTableModel::onOrderRemoved);
+    connect(m_orderManager, &OrderManager::ordersReset, this, &OrderTableModel::reset);
+}
+
+int OrderTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int OrderTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QSharedPointer<Order> OrderTableModel::orderAt(int row) const {
+    if (!m_customerId.isEmpty()) {
+        return (row >= 0 && row < m_filtered.size()) ? m_filtered.at(row) : nullptr;
+    }
+    return row < m_rowCount ? m_orderManager->orderAt(row) : nullptr;
+}
+
+QVariant OrderTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) return QVariant();
+
+    const QSharedPointer<Order> order = orderAt(index.row());
+    if (!order) return QVariant();
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case IdColumn:
+            return order->id();
+        case CustomerColumn:
+            return order->customerName();
+        case DateColumn:
+            return order->orderDate().toString("yyyy-MM-dd hh:mm");
+        case ItemsColumn:
+            return order->itemCount();
+        case TotalColumn:
+            return QString("$%1").arg(order->total(), 0, 'f', 2);
+        case StatusColumn:
+            return Order::statusToString(order->status());
+        }
+    } else if (index.column() == StatusColumn) {
+        if (role == Qt::BackgroundRole) {
+            switch (order->status()) {
+            case Order::Pending:
+                return QColor(255, 193, 7);
+            case Order::Processing:
+                return QColor(33, 150, 243);
+            case Order::Shipped:
+                return QColor(156, 39, 176);
+            case Order::Delivered:
+                return QColor(76, 175, 80);
+            case Order::Cancelled:
+                return QColor(244, 67, 54);
+            }
+        } else if (role == Qt::ForegroundRole) {
+            return QColor(Qt::white);
+        }
+    }
+    return QVariant();
+}
+
+QVariant OrderTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case IdColumn:
+        return tr("Order ID");
+    case CustomerColumn:
+        return tr("Customer");
+    case DateColumn:
+        return tr("Date");
+    case ItemsColumn:
+        return tr("Items");
+    case TotalColumn:
+        return tr("Total");
+    case StatusColumn:
+        return tr("Status");
+    }
+    return QVariant();
+}
+
+void OrderTableModel::setCustomerFilter(const QString& customerId) {
+    if (customerId == m_customerId) return;
+
+    m_customerId = customerId;
+    reset();
+}
+
+void OrderTableModel::onOrdersInserted(int first, int last) {
+    // The manager has already appended the rows; the view learns about them here
+    if (!m_customerId.isEmpty() || first != m_rowCount) {
+        reset();
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), first, last);
+    m_rowCount = last + 1;
+    endInsertRows();
+}
+
+void OrderTableModel::onOrdersUpdated(int first, int last) {
+    if (!m_customerId.isEmpty()) {
+        // The filtered rows are a different numbering, repaint them all
+        if (m_rowCount > 0) {
+            emit dataChanged(index(0, 0), index(m_rowCount - 1, ColumnCount - 1));
+        }
+        return;
+    }
+
+    if (last < m_rowCount) {
+        emit dataChanged(index(first, 0), index(last, ColumnCount - 1));
+    }
+}
+
+void OrderTableModel::onOrderRemoved(int row, int movedFrom) {
+    if (!m_customerId.isEmpty() || movedFrom != m_rowCount - 1) {
+        reset();
+        return;
+    }
+
+    // The manager swap-removed: the order at row went and the last order took
+    // its place. Report exactly that, so selections and the current index
+    // leave with the deleted order and follow the moved one. Removing row
+    // shifts the view's idea of the later rows up by one; moving the former
+    // last row back into the gap leaves them where they really are.
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rowCount = movedFrom;
+    endRemoveRows();
+
+    const int moved = movedFrom - 1; // the former last row, as the view now numbers it
+    if (moved > row) {
+        beginMoveRows(QModelIndex(), moved, moved, QModelIndex(), row);
+        endMoveRows();
+    }
+}
+
+void OrderTableModel::reset() {
+    beginResetModel();
+    if (m_customerId.isEmpty()) {
+        m_filtered.clear();
+        m_rowCount = m_orderManager->getTotalOrderCount();
+    } else {
+        m_filtered = m_orderManager->getOrdersByCustomer(m_customerId);
+        m_rowCount = m_filtered.size();
+    }
+    endResetModel();
+}
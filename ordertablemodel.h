@@ -0,0 +1,56 @@
+#ifndef ORDERTABLEMODEL_H
+#define ORDERTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QSharedPointer>
+#include "order.h"
+
+class OrderManager;
+
+// Table model that reads orders straight from OrderManager. Cells are
+// produced on demand in data(), so the cost of a refresh does not depend
+// on the number of orders. Without a customer filter the rows mirror
+// OrderManager::getAllOrders() and follow its row-level signals; with one
+// the (small) list of that customer's orders is rebuilt on change.
+class OrderTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        IdColumn,
+        CustomerColumn,
+        DateColumn,
+        ItemsColumn,
+        TotalColumn,
+        StatusColumn,
+        ColumnCount
+    };
+
+    explicit OrderTableModel(OrderManager* orderManager, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    QSharedPointer<Order> orderAt(int row) const;
+
+    // An empty id shows every order
+    void setCustomerFilter(const QString& customerId);
+    QString customerFilter() const { return m_customerId; }
+
+private:
+    void onOrdersInserted(int first, int last);
+    void onOrdersUpdated(int first, int last);
+    void onOrderRemoved(int row, int movedFrom);
+    void reset();
+
+    OrderManager* m_orderManager;
+    int m_rowCount = 0; // rows the view knows about, may briefly trail the manager
+
+    QString m_customerId;
+    QList<QSharedPointer<Order>> m_filtered;
+};
+
+#endif // ORDERTABLEMODEL_H
@@ -1,6 +1,7 @@
 #include "orderwidget.h"
 #include "ordermanager.h"
 #include "order.h"
+#include "ordertablemodel.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -16,22 +17,29 @@
 #include <QLineEdit>
 #include <QInputDialog>
 #include <QLabel>
+#include <QFileDialog>
 
 OrderWidget::OrderWidget(OrderManager* orderManager, QWidget *parent)
     : QWidget(parent), m_orderManager(orderManager)
 {
     setupUi();
-    loadOrders();
     updateStatistics();
 
-    connect(m_orderManager, &OrderManager::orderAdded, this, [this]() {
-        refreshOrderList();
-        updateStatistics();
+    // Rows follow the manager through m_orderModel; dataChanged comes once per batch
+    connect(m_orderManager, &OrderManager::dataChanged, this, &OrderWidget::updateStatistics);
+
+    connect(m_orderManager, &OrderManager::persistenceProgress, m_progressBar, &QProgressBar::setValue);
+    connect(m_orderManager, &OrderManager::loadFinished, this, [this](bool ok, const QString& error) {
+        setPersistenceRunning(false);
+        if (!ok && !m_cancelRequested) {
+            QMessageBox::warning(this, tr("Import Failed"), tr("Could not import orders: %1").arg(error));
+        }
     });
-    connect(m_orderManager, &OrderManager::orderUpdated, this, &OrderWidget::refreshOrderList);
-    connect(m_orderManager, &OrderManager::orderDeleted, this, [this]() {
-        refreshOrderList();
-        updateStatistics();
+    connect(m_orderManager, &OrderManager::saveFinished, this, [this](bool ok, const QString& error) {
+        setPersistenceRunning(false);
+        if (!ok && !m_cancelRequested) {
+            QMessageBox::warning(this, tr("Export Failed"), tr("Could not export orders: %1").arg(error));
+        }
     });
 }
 
@@ -65,6 +73,8 @@ void OrderWidget::setupUi() {
     m_updateBtn = new QPushButton(tr("Update Status"));
     m_deleteBtn = new QPushButton(tr("Delete Order"));
     m_viewBtn = new QPushButton(tr("View Details"));
+    m_importBtn = new QPushButton(tr("Import..."));
+    m_exportBtn = new QPushButton(tr("Export..."));
 
     m_updateBtn->setEnabled(false);
     m_deleteBtn->setEnabled(false);
@@ -79,20 +89,32 @@ void OrderWidget::setupUi() {
     controlsLayout->addWidget(m_updateBtn);
     controlsLayout->addWidget(m_deleteBtn);
     controlsLayout->addWidget(m_viewBtn);
+    controlsLayout->addWidget(m_importBtn);
+    controlsLayout->addWidget(m_exportBtn);
+
+    // Import/export progress, only visible while one runs
+    QHBoxLayout* progressLayout = new QHBoxLayout();
+    m_progressBar = new QProgressBar();
+    m_progressBar->setRange(0, 100);
+    m_cancelBtn = new QPushButton(tr("Cancel"));
+    progressLayout->addWidget(m_progressBar);
+    progressLayout->addWidget(m_cancelBtn);
+    m_progressBar->hide();
+    m_cancelBtn->hide();
 
     // Orders table
-    m_orderTable = new QTableWidget();
-    m_orderTable->setColumnCount(6);
-    m_orderTable->setHorizontalHeaderLabels({
-        tr("Order ID"), tr("Customer"), tr("Date"), tr("Items"), tr("Total"), tr("Status")
-    });
+    m_orderModel = new OrderTableModel(m_orderManager, this);
+    m_orderTable = new QTableView();
+    m_orderTable->setModel(m_orderModel);
     m_orderTable->horizontalHeader()->setStretchLastSection(true);
+    m_orderTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     m_orderTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_orderTable->setSelectionMode(QAbstractItemView::SingleSelection);
 
     // Add widgets to main layout
     mainLayout->addWidget(statsGroup);
     mainLayout->addWidget(controlsGroup);
+    mainLayout->addLayout(progressLayout);
     mainLayout->addWidget(m_orderTable);
 
     // Connect signals
@@ -100,47 +122,14 @@ void OrderWidget::setupUi() {
     connect(m_updateBtn, &QPushButton::clicked, this, &OrderWidget::updateOrderStatus);
     connect(m_deleteBtn, &QPushButton::clicked, this, &OrderWidget::deleteOrder);
     connect(m_viewBtn, &QPushButton::clicked, this, &OrderWidget::viewOrderDetails);
+    connect(m_importBtn, &QPushButton::clicked, this, &OrderWidget::importOrders);
+    connect(m_exportBtn, &QPushButton::clicked, this, &OrderWidget::exportOrders);
+    connect(m_cancelBtn, &QPushButton::clicked, this, [this]() {
+        m_cancelRequested = true;
+        m_orderManager->cancelPersistence();
+    });
     connect(m_customerFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &OrderWidget::refreshOrderList);
-    connect(m_orderTable, &QTableWidget::itemSelectionChanged, this, &OrderWidget::onOrderSelectionChanged);
-}
-
-void OrderWidget::loadOrders() {
-    m_orderTable->setRowCount(0);
-
-    QList<QSharedPointer<Order>> orders;
-    if (m_customerFilter->currentIndex() == 0) {
-        orders = m_orderManager->getAllOrders();
-    } else {
-        QString customerId = m_customerFilter->currentData().toString();
-        orders = m_orderManager->getOrdersByCustomer(customerId);
-    }
-
-    for (const auto& order : orders) {
-        int row = m_orderTable->rowCount();
-        m_orderTable->insertRow(row);
-
-        m_orderTable->setItem(row, 0, new QTableWidgetItem(order->id()));
-        m_orderTable->setItem(row, 1, new QTableWidgetItem(order->customerName()));
-        m_orderTable->setItem(row, 2, new QTableWidgetItem(order->orderDate().toString("yyyy-MM-dd hh:mm")));
-        m_orderTable->setItem(row, 3, new QTableWidgetItem(QString::number(order->items().size())));
-        m_orderTable->setItem(row, 4, new QTableWidgetItem(QString("$%1").arg(order->total(), 0, 'f', 2)));
-
-        QTableWidgetItem* statusItem = new QTableWidgetItem(Order::statusToString(order->status()));
-        switch (order->status()) {
-        case Order::Pending:
-            statusItem->setBackground(QColor(255, 193, 7)); break;
-        case Order::Processing:
-            statusItem->setBackground(QColor(33, 150, 243)); break;
-        case Order::Shipped:
-            statusItem->setBackground(QColor(156, 39, 176)); break;
-        case Order::Delivered:
-            statusItem->setBackground(QColor(76, 175, 80)); break;
-        case Order::Cancelled:
-            statusItem->setBackground(QColor(244, 67, 54)); break;
-        }
-        statusItem->setForeground(Qt::white);
-        m_orderTable->setItem(row, 5, statusItem);
-    }
+    connect(m_orderTable->selectionModel(), &QItemSelectionModel::selectionChanged, this, &OrderWidget::onOrderSelectionChanged);
 }
 
 void OrderWidget::createOrder() {
@@ -219,7 +208,7 @@ void OrderWidget::createOrder() {
             OrderItem item{productEdit->text(), quantitySpin->value(), priceSpin->value()};
             orderItems.append(item);
             itemsList->addItem(QString("%1 x%2 @ $%3 = $%4")
-                                   .arg(item.productName).arg(item.quantity).arg(item.price, 0, 'f', 2).arg(item.total(), 0, 'f', 2));
+                                   .arg(item.productName()).arg(item.quantity).arg(item.price, 0, 'f', 2).arg(item.total(), 0, 'f', 2));
             productEdit->clear(); quantitySpin->setValue(1); priceSpin->setValue(0.01);
             productEdit->setFocus();
             updateTotal();
@@ -252,30 +241,13 @@ void OrderWidget::createOrder() {
 }
 
 void OrderWidget::updateOrderStatus() {
-    QTableWidgetItem* selectedItem = m_orderTable->currentItem();
-    if (!selectedItem) {
+    QSharedPointer<Order> order = m_orderModel->orderAt(m_orderTable->currentIndex().row());
+    if (!order) {
         QMessageBox::warning(this, tr("Warning"), tr("Please select an order to update."));
         return;
     }
 
-    int row = selectedItem->row();
-    QString orderId = m_orderTable->item(row, 0)->text();
-
-    // Get all orders and find the one we need
-    QList<QSharedPointer<Order>> allOrders = m_orderManager->getAllOrders();
-    QSharedPointer<Order> order;
-
-    for (const auto& o : allOrders) {
-        if (o->id() == orderId) {
-            order = o;
-            break;
-        }
-    }
-
-    if (!order) {
-        QMessageBox::warning(this, tr("Warning"), tr("Order not found."));
-        return;
-    }
+    QString orderId = order->id();
 
     bool ok;
     QStringList statusOptions = {tr("Pending"), tr("Processing"), tr("Shipped"), tr("Delivered"), tr("Cancelled")};
@@ -285,10 +257,7 @@ void OrderWidget::updateOrderStatus() {
 
     if (ok) {
         Order::Status newStatus = static_cast<Order::Status>(statusOptions.indexOf(selectedStatus));
-        order->setStatus(newStatus);
-
-        // Trigger refresh since we don't have updateOrder method
-        emit m_orderManager->orderUpdated(order);
+        m_orderManager->updateOrderStatus(orderId, newStatus);
 
         QMessageBox::information(this, tr("Success"),
                                  tr("Order status updated to: %1").arg(selectedStatus));
@@ -296,15 +265,14 @@ void OrderWidget::updateOrderStatus() {
 }
 
 void OrderWidget::deleteOrder() {
-    QTableWidgetItem* selectedItem = m_orderTable->currentItem();
-    if (!selectedItem) {
+    QSharedPointer<Order> order = m_orderModel->orderAt(m_orderTable->currentIndex().row());
+    if (!order) {
         QMessageBox::warning(this, tr("Warning"), tr("Please select an order to delete."));
         return;
     }
 
-    int row = selectedItem->row();
-    QString orderId = m_orderTable->item(row, 0)->text();
-    QString customerName = m_orderTable->item(row, 1)->text();
+    QString orderId = order->id();
+    QString customerName = order->customerName();
 
     int ret = QMessageBox::question(this, tr("Confirm Delete"),
                                     tr("Are you sure you want to delete order %1 for %2?")
@@ -318,41 +286,24 @@ void OrderWidget::deleteOrder() {
 }
 
 void OrderWidget::refreshOrderList() {
-    loadOrders();
+    m_orderModel->setCustomerFilter(m_customerFilter->currentData().toString());
 }
 
 void OrderWidget::onOrderSelectionChanged() {
-    bool hasSelection = m_orderTable->currentRow() >= 0;
+    bool hasSelection = m_orderTable->currentIndex().isValid();
     m_updateBtn->setEnabled(hasSelection);
     m_deleteBtn->setEnabled(hasSelection);
     m_viewBtn->setEnabled(hasSelection);
 }
 
 void OrderWidget::viewOrderDetails() {
-    QTableWidgetItem* selectedItem = m_orderTable->currentItem();
-    if (!selectedItem) {
+    QSharedPointer<Order> order = m_orderModel->orderAt(m_orderTable->currentIndex().row());
+    if (!order) {
         QMessageBox::warning(this, tr("Warning"), tr("Please select an order to view."));
         return;
     }
 
-    int row = selectedItem->row();
-    QString orderId = m_orderTable->item(row, 0)->text();
-
-    // Get all orders and find the one we need
-    QList<QSharedPointer<Order>> allOrders = m_orderManager->getAllOrders();
-    QSharedPointer<Order> order;
-
-    for (const auto& o : allOrders) {
-        if (o->id() == orderId) {
-            order = o;
-            break;
-        }
-    }
-
-    if (!order) {
-        QMessageBox::warning(this, tr("Warning"), tr("Order not found."));
-        return;
-    }
+    QString orderId = order->id();
 
     QDialog dialog(this);
     dialog.setWindowTitle(tr("Order Details - %1").arg(orderId));
@@ -381,11 +332,11 @@ void OrderWidget::viewOrderDetails() {
     itemsTable->horizontalHeader()->setStretchLastSection(true);
 
     const auto& items = order->items();
-    itemsTable->setRowCount(items.size());
+    itemsTable->setRowCount(order->itemCount());
 
-    for (int i = 0; i < items.size(); ++i) {
+    for (int i = 0; i < order->itemCount(); ++i) {
         const auto& item = items[i];
-        itemsTable->setItem(i, 0, new QTableWidgetItem(item.productName));
+        itemsTable->setItem(i, 0, new QTableWidgetItem(item.productName()));
         itemsTable->setItem(i, 1, new QTableWidgetItem(QString::number(item.quantity)));
         itemsTable->setItem(i, 2, new QTableWidgetItem(QString("$%1").arg(item.price, 0, 'f', 2)));
         itemsTable->setItem(i, 3, new QTableWidgetItem(QString("$%1").arg(item.total(), 0, 'f', 2)));
@@ -404,17 +355,46 @@ void OrderWidget::viewOrderDetails() {
     dialog.exec();
 }
 
-void OrderWidget::updateStatistics() {
-    QList<QSharedPointer<Order>> allOrders = m_orderManager->getAllOrders();
+void OrderWidget::importOrders() {
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Import Orders"), "",
+                                                    tr("Order Files (*.json *.snapshot);;All Files (*)"));
+    if (fileName.isEmpty()) return;
+
+    if (m_orderManager->loadFromFileAsync(fileName)) {
+        setPersistenceRunning(true);
+    }
+}
 
-    int orderCount = allOrders.size();
-    double totalRevenue = 0.0;
+void OrderWidget::exportOrders() {
+    QString selectedFilter;
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Orders"), "orders.json",
+                                                    tr("JSON Files (*.json);;Order Snapshots (*.snapshot)"),
+                                                    &selectedFilter);
+    if (fileName.isEmpty()) return;
+
+    const OrderManager::FileFormat format = selectedFilter.contains("*.snapshot")
+                                                ? OrderManager::BinaryFormat
+                                                : OrderManager::JsonFormat;
+    if (m_orderManager->saveToFileAsync(fileName, format)) {
+        setPersistenceRunning(true);
+    }
+}
 
-    for (const auto& order : allOrders) {
-        totalRevenue += order->total();
+void OrderWidget::setPersistenceRunning(bool running) {
+    if (running) {
+        m_cancelRequested = false;
+        m_progressBar->setValue(0);
     }
+    m_progressBar->setVisible(running);
+    m_cancelBtn->setVisible(running);
+    m_importBtn->setEnabled(!running);
+    m_exportBtn->setEnabled(!running);
+}
 
-    double avgOrder = orderCount > 0 ? totalRevenue / orderCount : 0.0;
+void OrderWidget::updateStatistics() {
+    int orderCount = m_orderManager->getTotalOrderCount();
+    double totalRevenue = m_orderManager->getTotalRevenue();
+    double avgOrder = m_orderManager->getAverageOrderValue();
 
     m_totalRevenueLabel->setText(tr("Total Revenue: $%1").arg(totalRevenue, 0, 'f', 2));
     m_orderCountLabel->setText(tr("Orders: %1").arg(orderCount));
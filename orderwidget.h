@@ -3,13 +3,16 @@
 
 #include <QWidget>
 #include <QTableWidget>
+#include <QTableView>
 #include <QComboBox>
 #include <QPushButton>
 #include <QLabel>
+#include <QProgressBar>
 #include <QInputDialog>
 #include <QFormLayout>
 
 class OrderManager;
+class OrderTableModel;
 
 class OrderWidget : public QWidget {
     Q_OBJECT
@@ -24,20 +27,30 @@ private slots:
     void refreshOrderList();
     void onOrderSelectionChanged();
     void viewOrderDetails();
+    void importOrders();
+    void exportOrders();
 
 private:
     void setupUi();
-    void loadOrders();
     void updateStatistics();
+    void setPersistenceRunning(bool running);
 
     OrderManager* m_orderManager;
-    QTableWidget* m_orderTable;
+    QTableView* m_orderTable;
+    OrderTableModel* m_orderModel;
     QComboBox* m_customerFilter;
     QComboBox* m_statusCombo;
     QPushButton* m_createBtn;
     QPushButton* m_updateBtn;
     QPushButton* m_deleteBtn;
     QPushButton* m_viewBtn;
+    QPushButton* m_importBtn;
+    QPushButton* m_exportBtn;
+
+    // Background import/export progress
+    QProgressBar* m_progressBar;
+    QPushButton* m_cancelBtn;
+    bool m_cancelRequested = false;
 
     // Statistics labels
     QLabel* m_totalRevenueLabel;
@@ -0,0 +1,6 @@
+#include "parallelscan.h"
+
+QThreadPool* ParallelScan::pool() {
+    static QThreadPool scanPool;
+    return &scanPool;
+}
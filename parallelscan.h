@@ -0,0 +1,77 @@
+#ifndef PARALLELSCAN_H
+#define PARALLELSCAN_H
+
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Chunked parallel map over a row range, used by the order scan kernels.
+//
+// The range is cut into chunks of a fixed size, independent of the number
+// of threads, and every chunk's result lands in its own slot. Callers reduce
+// the slots in chunk order, so a floating point sum comes out bit for bit
+// the same whether one core or sixteen did the work.
+namespace ParallelScan {
+
+// Below this many rows the scan stays on the calling thread
+constexpr qsizetype MinRows = 1 << 16;
+constexpr qsizetype ChunkRows = 1 << 14;
+
+// Dedicated pool, so scans do not queue behind unrelated global pool work
+QThreadPool* pool();
+
+template <typename Result, typename ChunkFn>
+std::vector<Result> mapChunks(qsizetype rows, ChunkFn chunkFn) {
+    const qsizetype chunks = (rows + ChunkRows - 1) / ChunkRows;
+    std::vector<Result> results(chunks);
+    if (rows < MinRows) {
+        for (qsizetype c = 0; c < chunks; ++c) {
+            results[c] = chunkFn(c * ChunkRows, qMin(rows, (c + 1) * ChunkRows));
+        }
+        return results;
+    }
+
+    // Chunks are claimed from a shared counter and the calling thread claims
+    // them too. It therefore finishes even if no pool thread gets to run, and
+    // it only waits for chunks that were actually claimed. A helper that
+    // starts late finds nothing left and touches no caller state.
+    struct Shared {
+        std::atomic<qsizetype> next{0};
+        qsizetype done = 0;
+        QMutex mutex;
+        QWaitCondition finished;
+    };
+    auto shared = std::make_shared<Shared>();
+    auto work = [shared, chunks, rows, &results, &chunkFn]() {
+        qsizetype completed = 0;
+        for (qsizetype c = shared->next++; c < chunks; c = shared->next++) {
+            results[c] = chunkFn(c * ChunkRows, qMin(rows, (c + 1) * ChunkRows));
+            ++completed;
+        }
+        if (completed > 0) {
+            QMutexLocker locker(&shared->mutex);
+            shared->done += completed;
+            if (shared->done == chunks) shared->finished.wakeAll();
+        }
+    };
+
+    QThreadPool* threads = pool();
+    const qsizetype helpers = qMin<qsizetype>(threads->maxThreadCount(), chunks) - 1;
+    for (qsizetype i = 0; i < helpers; ++i) {
+        threads->start(work);
+    }
+    work();
+
+    QMutexLocker locker(&shared->mutex);
+    while (shared->done < chunks) {
+        shared->finished.wait(&shared->mutex);
+    }
+    return results;
+}
+
+} // namespace ParallelScan
+
+#endif // PARALLELSCAN_H
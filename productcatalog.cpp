@@ -0,0 +1,38 @@
+#include "productcatalog.h"
+
+ProductCatalog& ProductCatalog::instance() {
+    static ProductCatalog catalog;
+    return catalog;
+}
+
+int ProductCatalog::intern(const QString& name) {
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_ids.constFind(name);
+        if (it != m_ids.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+    // Another thread may have added it between the two locks
+    auto it = m_ids.constFind(name);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+
+    const int id = m_names.size();
+    m_ids.insert(name, id);
+    m_names.append(name);
+    return id;
+}
+
+QString ProductCatalog::name(int productId) const {
+    QReadLocker locker(&m_lock);
+    return m_names.value(productId);
+}
+
+int ProductCatalog::size() const {
+    QReadLocker locker(&m_lock);
+    return m_names.size();
+}
@@ -0,0 +1,28 @@
+#ifndef PRODUCTCATALOG_H
+#define PRODUCTCATALOG_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+
+// Process-wide table of product names. Every distinct name is stored once
+// and order items refer to it by integer id.
+class ProductCatalog {
+public:
+    static ProductCatalog& instance();
+
+    int intern(const QString& name);
+    QString name(int productId) const;
+    int size() const;
+
+private:
+    ProductCatalog() = default;
+    Q_DISABLE_COPY(ProductCatalog)
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, int> m_ids;
+    QStringList m_names;
+};
+
+#endif // PRODUCTCATALOG_H
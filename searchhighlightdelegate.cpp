@@ -0,0 +1,87 @@
+#include "searchhighlightdelegate.h"
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+#include <QTextOption>
+
+SearchHighlightDelegate::SearchHighlightDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void SearchHighlightDelegate::setQuery(const QString& text, CustomerSearchMode mode)
+{
+    m_text = text;
+    m_mode = mode;
+}
+
+QList<QTextLayout::FormatRange> SearchHighlightDelegate::matchRanges(const QString& text) const
+{
+    QList<QTextLayout::FormatRange> ranges;
+    if (m_text.isEmpty() || text.isEmpty()) return ranges;
+
+    QTextCharFormat format;
+    format.setBackground(m_highlight);
+
+    if (m_mode == CustomerSearchMode::Exact) {
+        if (text.compare(m_text, Qt::CaseInsensitive) == 0) {
+            ranges.append({0, int(text.size()), format});
+        }
+        return ranges;
+    }
+
+    for (qsizetype pos = text.indexOf(m_text, 0, Qt::CaseInsensitive); pos >= 0;
+         pos = text.indexOf(m_text, pos + m_text.size(), Qt::CaseInsensitive)) {
+        ranges.append({int(pos), int(m_text.size()), format});
+    }
+    return ranges;
+}
+
+void SearchHighlightDelegate::paint(QPainter *painter, const QStyleOptionViewItem& option,
+                                    const QModelIndex& index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+
+    const QList<QTextLayout::FormatRange> ranges = matchRanges(opt.text);
+    if (ranges.isEmpty()) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    // Let the style draw the background, selection and focus, then draw the
+    // text ourselves so the matched ranges can carry a background
+    const QString text = opt.text;
+    opt.text.clear();
+    const QWidget *widget = opt.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    const int margin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, widget) + 1;
+    const QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget)
+                               .adjusted(margin, 0, -margin, 0);
+
+    QTextOption textOption(opt.displayAlignment);
+    textOption.setWrapMode(QTextOption::NoWrap);
+
+    QTextLayout layout(text, opt.font);
+    layout.setTextOption(textOption);
+    layout.setFormats(ranges);
+    layout.beginLayout();
+    QTextLine line = layout.createLine();
+    line.setLineWidth(textRect.width());
+    layout.endLayout();
+
+    const QPalette::ColorGroup group = !(opt.state & QStyle::State_Enabled) ? QPalette::Disabled
+                                     : (opt.state & QStyle::State_Active) ? QPalette::Normal
+                                                                          : QPalette::Inactive;
+    const QPalette::ColorRole role = (opt.state & QStyle::State_Selected)
+                                         ? QPalette::HighlightedText : QPalette::Text;
+
+    painter->save();
+    painter->setClipRect(textRect);
+    painter->setPen(opt.palette.color(group, role));
+    const qreal top = textRect.top() + (textRect.height() - line.height()) / 2;
+    layout.draw(painter, QPointF(textRect.left(), top));
+    painter->restore();
+}
@@ -0,0 +1,34 @@
+#ifndef SEARCHHIGHLIGHTDELEGATE_H
+#define SEARCHHIGHLIGHTDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QColor>
+#include <QTextLayout>
+#include "customersearchengine.h"
+
+// Paints the parts of a cell that match the current search query over a
+// highlight colour. Matches are found while painting, so only visible cells
+// pay for them and the model is never touched; after setQuery() the view
+// just needs a repaint.
+class SearchHighlightDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit SearchHighlightDelegate(QObject *parent = nullptr);
+
+    void setQuery(const QString& text, CustomerSearchMode mode);
+    QString query() const { return m_text; }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem& option,
+               const QModelIndex& index) const override;
+
+private:
+    // Fuzzy queries only highlight where the text occurs as typed
+    QList<QTextLayout::FormatRange> matchRanges(const QString& text) const;
+
+    QString m_text;
+    CustomerSearchMode m_mode = CustomerSearchMode::Substring;
+    QColor m_highlight = QColor(241, 196, 15, 120);
+};
+
+#endif // SEARCHHIGHLIGHTDELEGATE_H
@@ -0,0 +1,104 @@
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include <QtTest>
+#include "ordermanager.h"
+
+// Saves the same orders as JSON and as a binary snapshot, loads both back
+// and checks that every persisted field survived either way
+class TestOrderRoundTrip : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void jsonRoundTrip();
+    void snapshotRoundTrip();
+    void formatsAgree();
+
+private:
+    QList<QSharedPointer<Order>> load(const QString& filename);
+    static void compare(const QList<QSharedPointer<Order>>& expected,
+                        const QList<QSharedPointer<Order>>& actual);
+
+    QTemporaryDir m_dir;
+    QString m_jsonPath;
+    QString m_snapshotPath;
+    QList<QSharedPointer<Order>> m_saved;
+};
+
+void TestOrderRoundTrip::initTestCase() {
+    QVERIFY(m_dir.isValid());
+    m_jsonPath = m_dir.filePath("orders.json");
+    m_snapshotPath = m_dir.filePath("orders.snapshot");
+
+    static const QStringList products = {"Laptop", "Monitor", "Keyboard", "Café crème", "Dock"};
+    // UTC, so every timestamp survives JSON's text form, DST changes included
+    const QDateTime start = QDateTime::fromMSecsSinceEpoch(Q_INT64_C(1577836800000), QTimeZone::utc());
+    QRandomGenerator random(1);
+
+    QList<QSharedPointer<Order>> orders;
+    for (int i = 0; i < 1000; ++i) {
+        auto order = QSharedPointer<Order>::create(Order::formatId(quint64(i + 1) << 22),
+                                                   QStringLiteral("CUST%1").arg(i % 97),
+                                                   start.addMSecs(random.bounded(Q_INT64_C(157680000000))));
+        order->setCustomerName(i % 10 == 0 ? QStringLiteral("Zoë Ångström %1").arg(i)
+                                           : QStringLiteral("Customer %1").arg(i % 97));
+        order->setStatus(Order::Status(i % Order::StatusCount));
+
+        // No items, a few, and more than fit inline in Order::ItemList
+        const int items = i % 9;
+        for (int j = 0; j < items; ++j) {
+            order->addItem({products[(i + j) % products.size()], 1 + j, 0.01 * random.bounded(100000)});
+        }
+        orders.append(order);
+    }
+
+    OrderManager writer;
+    writer.setConsistencyChecks(true);
+    writer.addOrders(orders);
+    QVERIFY(writer.saveToFile(m_jsonPath, OrderManager::JsonFormat));
+    QVERIFY(writer.saveToFile(m_snapshotPath, OrderManager::BinaryFormat));
+    m_saved = writer.getAllOrders(); // includes the manager's sample orders
+}
+
+QList<QSharedPointer<Order>> TestOrderRoundTrip::load(const QString& filename) {
+    OrderManager reader;
+    reader.setConsistencyChecks(true);
+    if (!reader.loadFromFile(filename)) return {};
+    return reader.getAllOrders();
+}
+
+void TestOrderRoundTrip::compare(const QList<QSharedPointer<Order>>& expected,
+                                 const QList<QSharedPointer<Order>>& actual) {
+    QCOMPARE(actual.size(), expected.size());
+    for (int i = 0; i < expected.size(); ++i) {
+        const Order& want = *expected[i];
+        const Order& got = *actual[i];
+        QCOMPARE(got.id(), want.id());
+        QCOMPARE(got.customerId(), want.customerId());
+        QCOMPARE(got.customerName(), want.customerName());
+        QCOMPARE(got.orderDate().toMSecsSinceEpoch(), want.orderDate().toMSecsSinceEpoch());
+        QCOMPARE(got.status(), want.status());
+        QCOMPARE(got.itemCount(), want.itemCount());
+        for (int j = 0; j < want.itemCount(); ++j) {
+            QCOMPARE(got.items()[j].productName(), want.items()[j].productName());
+            QCOMPARE(got.items()[j].quantity, want.items()[j].quantity);
+            QCOMPARE(got.items()[j].price, want.items()[j].price);
+        }
+        QCOMPARE(got.total(), want.total());
+    }
+}
+
+void TestOrderRoundTrip::jsonRoundTrip() {
+    compare(m_saved, load(m_jsonPath));
+}
+
+void TestOrderRoundTrip::snapshotRoundTrip() {
+    compare(m_saved, load(m_snapshotPath));
+}
+
+void TestOrderRoundTrip::formatsAgree() {
+    compare(load(m_jsonPath), load(m_snapshotPath));
+}
+
+QTEST_GUILESS_MAIN(TestOrderRoundTrip)
+#include "tst_orderroundtrip.moc"
@@ -0,0 +1,274 @@
+#include "trigramindex.h"
+#include "parallelscan.h"
+#include <algorithm>
+
+void TrigramIndex::clear() {
+    m_docs.clear();
+    m_freeSlots.clear();
+    m_slots.clear();
+    m_postings.clear();
+}
+
+void TrigramIndex::reserve(int count) {
+    m_docs.reserve(count);
+    m_slots.reserve(count);
+}
+
+std::vector<quint64> TrigramIndex::trigramsOf(const QString& text) {
+    std::vector<quint64> trigrams;
+    if (text.size() < 3) return trigrams;
+
+    trigrams.reserve(text.size() - 2);
+    for (qsizetype i = 0; i + 2 < text.size(); ++i) {
+        trigrams.push_back(quint64(text[i].unicode()) << 32
+                           | quint64(text[i + 1].unicode()) << 16
+                           | quint64(text[i + 2].unicode()));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+void TrigramIndex::addPosting(int slot, quint64 trigram,
+                              std::vector<quint64>& trigrams, std::vector<int>& positions) {
+    std::vector<int>& posting = m_postings[trigram];
+    trigrams.push_back(trigram);
+    positions.push_back(static_cast<int>(posting.size()));
+    posting.push_back(slot);
+}
+
+void TrigramIndex::removePosting(int slot, quint64 trigram, int position) {
+    auto posting = m_postings.find(trigram);
+    if (posting == m_postings.end()) return;
+
+    // Move the last entry into the hole and tell its document where it went
+    const int moved = posting->back();
+    if (moved != slot) {
+        (*posting)[position] = moved;
+        Document& movedDoc = m_docs[moved];
+        auto it = std::lower_bound(movedDoc.trigrams.begin(), movedDoc.trigrams.end(), trigram);
+        movedDoc.positions[it - movedDoc.trigrams.begin()] = position;
+    }
+    posting->pop_back();
+    if (posting->empty()) {
+        m_postings.erase(posting);
+    }
+}
+
+void TrigramIndex::insert(const QString& key, const QString& text) {
+    if (key.isEmpty()) return; // empty keys mark free slots
+
+    int slot;
+    auto existing = m_slots.constFind(key);
+    if (existing != m_slots.constEnd()) {
+        slot = existing.value();
+    } else if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_slots.insert(key, slot);
+    } else {
+        slot = static_cast<int>(m_docs.size());
+        m_docs.emplace_back();
+        m_slots.insert(key, slot);
+    }
+
+    const QString lowered = text.toLower();
+    const std::vector<quint64> next = trigramsOf(lowered);
+
+    // Walk the old and new sorted trigram sets together. Shared trigrams keep
+    // their posting entries; only the difference is removed and added.
+    std::vector<quint64> oldTrigrams;
+    std::vector<int> oldPositions;
+    oldTrigrams.swap(m_docs[slot].trigrams);
+    oldPositions.swap(m_docs[slot].positions);
+
+    std::vector<quint64> trigrams;
+    std::vector<int> positions;
+    trigrams.reserve(next.size());
+    positions.reserve(next.size());
+
+    size_t o = 0;
+    for (quint64 trigram : next) {
+        while (o < oldTrigrams.size() && oldTrigrams[o] < trigram) {
+            removePosting(slot, oldTrigrams[o], oldPositions[o]);
+            ++o;
+        }
+        if (o < oldTrigrams.size() && oldTrigrams[o] == trigram) {
+            trigrams.push_back(trigram);
+            positions.push_back(oldPositions[o]);
+            ++o;
+        } else {
+            addPosting(slot, trigram, trigrams, positions);
+        }
+    }
+    for (; o < oldTrigrams.size(); ++o) {
+        removePosting(slot, oldTrigrams[o], oldPositions[o]);
+    }
+
+    // next is sorted, so trigrams is too
+    Document& doc = m_docs[slot];
+    doc.key = key;
+    doc.text = m_storeText ? lowered : QString();
+    doc.trigrams = std::move(trigrams);
+    doc.positions = std::move(positions);
+}
+
+void TrigramIndex::remove(const QString& key) {
+    auto it = m_slots.find(key);
+    if (it == m_slots.end()) return;
+
+    const int slot = it.value();
+    m_slots.erase(it);
+
+    Document& doc = m_docs[slot];
+    for (size_t i = 0; i < doc.trigrams.size(); ++i) {
+        removePosting(slot, doc.trigrams[i], doc.positions[i]);
+    }
+
+    doc.key.clear();
+    doc.text.clear();
+    doc.trigrams.clear();
+    doc.positions.clear();
+    m_freeSlots.push_back(slot);
+}
+
+const std::vector<int>* TrigramIndex::rarestPosting(const QString& query) const {
+    static const std::vector<int> empty;
+    const std::vector<int>* rarest = nullptr;
+    for (quint64 trigram : trigramsOf(query)) {
+        auto posting = m_postings.constFind(trigram);
+        if (posting == m_postings.constEnd()) {
+            return &empty;
+        }
+        if (!rarest || posting->size() < rarest->size()) {
+            rarest = &posting.value();
+        }
+    }
+    return rarest; // null when the query is too short to have trigrams
+}
+
+int TrigramIndex::estimate(const QString& query) const {
+    const std::vector<int>* posting = rarestPosting(query.toLower());
+    return posting ? static_cast<int>(posting->size()) : size();
+}
+
+QString TrigramIndex::text(const QString& key) const {
+    auto slot = m_slots.constFind(key);
+    return slot != m_slots.constEnd() ? m_docs[slot.value()].text : QString();
+}
+
+std::vector<std::pair<QString, int>> TrigramIndex::similar(const QString& query, int minShared, int limit,
+                                                           const std::atomic<bool>* cancelled) const {
+    const int needed = qMax(1, minShared);
+    std::vector<std::pair<quint64, const std::vector<int>*>> postings;
+    for (quint64 trigram : trigramsOf(query.toLower())) {
+        auto posting = m_postings.constFind(trigram);
+        if (posting != m_postings.constEnd()) postings.emplace_back(trigram, &posting.value());
+    }
+    if (int(postings.size()) < needed) return {};
+
+    // A document sharing `needed` of the trigrams must appear in at least one
+    // of the len - needed + 1 rarest postings, so only those admit candidates.
+    // The common ones can cover nearly every document; they only add to the
+    // counts of admitted documents, probing each one's sorted trigrams when
+    // that is cheaper than walking the posting.
+    std::sort(postings.begin(), postings.end(), [](const auto& a, const auto& b) {
+        return a.second->size() < b.second->size();
+    });
+    const size_t admitting = postings.size() - size_t(needed) + 1;
+
+    std::vector<int> shared(m_docs.size(), 0); // slot -> trigrams in common with the query
+    std::vector<int> admitted;
+    size_t visited = 0;
+    for (size_t i = 0; i < postings.size(); ++i) {
+        const auto& [trigram, posting] = postings[i];
+        if (i >= admitting && admitted.size() * 16 < posting->size()) {
+            for (int slot : admitted) {
+                if ((++visited & 0xfff) == 0 && cancelled && *cancelled) return {};
+                const std::vector<quint64>& trigrams = m_docs[slot].trigrams;
+                if (std::binary_search(trigrams.begin(), trigrams.end(), trigram)) ++shared[slot];
+            }
+            continue;
+        }
+        for (int slot : *posting) {
+            if ((++visited & 0xfff) == 0 && cancelled && *cancelled) return {};
+            if (shared[slot] > 0) {
+                ++shared[slot];
+            } else if (i < admitting) {
+                shared[slot] = 1;
+                admitted.push_back(slot);
+            }
+        }
+    }
+    if (cancelled && *cancelled) return {};
+
+    std::vector<std::pair<int, int>> ranked; // (shared, slot)
+    for (int slot : admitted) {
+        if (shared[slot] >= needed) {
+            ranked.emplace_back(shared[slot], slot);
+        }
+    }
+
+    // Ties go to the lower slot so the cut does not depend on posting order
+    auto moreShared = [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    const size_t count = qMin(ranked.size(), size_t(qMax(0, limit)));
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), moreShared);
+
+    std::vector<std::pair<QString, int>> candidates;
+    candidates.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        candidates.emplace_back(m_docs[ranked[i].second].key, ranked[i].first);
+    }
+    return candidates;
+}
+
+QStringList TrigramIndex::search(const QString& query, const std::atomic<bool>* cancelled) const {
+    return search(query, Matcher(), cancelled);
+}
+
+QStringList TrigramIndex::search(const QString& query, const Matcher& matcher,
+                                 const std::atomic<bool>* cancelled) const {
+    const QString needle = query.toLower();
+    const std::vector<int>* posting = rarestPosting(needle);
+
+    // Queries shorter than a trigram fall back to checking every document
+    const qsizetype candidates = posting ? qsizetype(posting->size()) : qsizetype(m_docs.size());
+
+    // (match position, slot) of every verified document. Large candidate sets
+    // are verified in parallel chunks, concatenated in chunk order, so the
+    // result is the same as a sequential scan.
+    using Hits = std::vector<std::pair<qsizetype, int>>;
+    const std::vector<Hits> chunkHits = ParallelScan::mapChunks<Hits>(candidates, [&](qsizetype begin, qsizetype end) {
+        Hits found;
+        if (cancelled && *cancelled) return found;
+        for (qsizetype i = begin; i < end; ++i) {
+            const int slot = posting ? (*posting)[i] : int(i);
+            const Document& doc = m_docs[slot];
+            if (doc.key.isEmpty()) continue;
+            const qsizetype pos = matcher ? matcher(doc.key, needle) : doc.text.indexOf(needle);
+            if (pos >= 0) {
+                found.emplace_back(pos, slot);
+            }
+        }
+        return found;
+    });
+
+    if (cancelled && *cancelled) return QStringList();
+
+    Hits hits;
+    for (const Hits& found : chunkHits) {
+        hits.insert(hits.end(), found.begin(), found.end());
+    }
+
+    // Postings are unordered, so ties on the position go to the lower slot
+    std::sort(hits.begin(), hits.end());
+
+    QStringList keys;
+    keys.reserve(hits.size());
+    for (const auto& hit : hits) {
+        keys.append(m_docs[hit.second].key);
+    }
+    return keys;
+}
@@ -0,0 +1,81 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// Inverted trigram index for case-insensitive substring search. Each
+// document is a key plus a lowercased text; a query is answered by
+// verifying only the documents in its rarest trigram's posting list.
+//
+// The index keeps a copy of every text unless told not to. Without one,
+// searches verify candidates through a Matcher that looks at the caller's
+// own data, so the text is not held in memory twice.
+//
+// Postings are unordered, and every document remembers where it sits in
+// each of its postings, so removing a document is a swap with the last
+// entry of each list rather than a shift of the whole list.
+class TrigramIndex {
+public:
+    // Position of needle, already lowercased, in the text indexed under key,
+    // or -1. Called from several threads at once by a large search.
+    using Matcher = std::function<qsizetype(const QString& key, const QString& needle)>;
+
+    // storeText false keeps only the trigrams; text() is then empty and
+    // search() needs a Matcher
+    explicit TrigramIndex(bool storeText = true) : m_storeText(storeText) {}
+
+    void clear();
+    void reserve(int count);
+    int size() const { return m_slots.size(); }
+    bool contains(const QString& key) const { return m_slots.contains(key); }
+
+    // Adds or replaces the document stored under key. A replacement keeps
+    // its slot and only touches the postings of trigrams that changed.
+    void insert(const QString& key, const QString& text);
+    void remove(const QString& key);
+
+    // Keys whose text contains query, earliest match position first. Once
+    // *cancelled is set the scan stops between chunks and returns nothing.
+    QStringList search(const QString& query, const std::atomic<bool>* cancelled = nullptr) const;
+    QStringList search(const QString& query, const Matcher& matcher,
+                       const std::atomic<bool>* cancelled = nullptr) const;
+
+    // Upper bound on the number of documents search() would have to verify
+    int estimate(const QString& query) const;
+
+    // Lowercased text stored under key, empty if there is none
+    QString text(const QString& key) const;
+
+    // Keys of the documents sharing at least minShared of the query's
+    // trigrams, with the shared count, most shared first and at most limit
+    // of them. Candidates for approximate matching; callers verify.
+    // Cancellation is checked every few thousand posting entries.
+    std::vector<std::pair<QString, int>> similar(const QString& query, int minShared, int limit,
+                                                 const std::atomic<bool>* cancelled = nullptr) const;
+
+private:
+    struct Document {
+        QString key;  // empty for a free slot
+        QString text; // lowercased; empty unless m_storeText
+        std::vector<quint64> trigrams; // sorted, unique
+        std::vector<int> positions;    // positions[i]: index of this slot in the posting of trigrams[i]
+    };
+
+    static std::vector<quint64> trigramsOf(const QString& text);
+    const std::vector<int>* rarestPosting(const QString& query) const;
+    void addPosting(int slot, quint64 trigram, std::vector<quint64>& trigrams, std::vector<int>& positions);
+    void removePosting(int slot, quint64 trigram, int position);
+
+    bool m_storeText;
+    std::vector<Document> m_docs;
+    std::vector<int> m_freeSlots;
+    QHash<QString, int> m_slots;                   // key -> slot in m_docs
+    QHash<quint64, std::vector<int>> m_postings;   // trigram -> slots, unordered
+};
+
+#endif // TRIGRAMINDEX_H